@@ -0,0 +1,97 @@
+# Copyright (c) 2018 NicoHood
+# See the readme for credit to other people.
+#
+# Permission is hereby granted, free of charge, to any person obtaining a copy
+# of this software and associated documentation files (the "Software"), to deal
+# in the Software without restriction, including without limitation the rights
+# to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+# copies of the Software, and to permit persons to whom the Software is
+# furnished to do so, subject to the following conditions:
+#
+# The above copyright notice and this permission notice shall be included in
+# all copies or substantial portions of the Software.
+#
+# THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+# IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+# FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+# AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+# LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+# OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+# THE SOFTWARE.
+
+
+# Include Guard
+ifeq ($(filter BENCH, $(DMBS_BUILD_MODULES)),)
+
+# Sanity check user supplied DMBS path
+ifndef DMBS_PATH
+$(error Makefile DMBS_PATH option cannot be blank)
+endif
+
+# Location of the current module
+BENCH_MODULE_PATH := $(patsubst %/,%,$(dir $(lastword $(MAKEFILE_LIST))))
+
+# Import the CORE module of DMBS
+include $(DMBS_PATH)/core.mk
+
+# This module needs to be included before gcc.mk
+ifneq ($(filter GCC, $(DMBS_BUILD_MODULES)),)
+$(error Include this module before gcc.mk)
+endif
+
+# Default values of optionally user-supplied variables
+BENCH_OUTPUT        ?= bench.csv
+BENCH_LOOPBACK      ?=
+BENCH_MAX_CYCLES    ?= 100000000
+BENCH_HOST_CC       ?= cc
+BENCH_SIMAVR_CFLAGS ?= -I/usr/include/simavr -I/usr/local/include/simavr
+BENCH_SIMAVR_LIBS   ?= -lsimavr -lelf
+
+# Help settings
+DMBS_BUILD_MODULES         += BENCH
+DMBS_BUILD_TARGETS         += bench
+DMBS_BUILD_MANDATORY_VARS  += DMBS_PATH MCU F_CPU TARGET
+DMBS_BUILD_OPTIONAL_VARS   += BENCH_OUTPUT BENCH_LOOPBACK BENCH_MAX_CYCLES
+DMBS_BUILD_OPTIONAL_VARS   += BENCH_HOST_CC BENCH_SIMAVR_CFLAGS BENCH_SIMAVR_LIBS
+DMBS_BUILD_PROVIDED_VARS   += BENCH_SRC
+DMBS_BUILD_PROVIDED_MACROS +=
+
+# Sanity check user supplied values
+$(foreach MANDATORY_VAR, $(DMBS_BUILD_MANDATORY_VARS), $(call ERROR_IF_UNSET, $(MANDATORY_VAR)))
+$(call ERROR_IF_EMPTY, BENCH_OUTPUT)
+$(call ERROR_IF_EMPTY, BENCH_MAX_CYCLES)
+
+# BENCH Library
+BENCH_SRC := $(BENCH_MODULE_PATH)/src/bench.c
+
+# Compiler flags and sources
+SRC                += $(BENCH_SRC)
+CC_FLAGS           += -DDMBS_MODULE_BENCH
+CC_FLAGS           += -I$(BENCH_MODULE_PATH)/include
+
+# Host side simulator runner. It loads the firmware into simavr, collects the
+# results written to the bench console register and optionally loops back an USART.
+BENCH_RUNNER       := $(BENCH_MODULE_PATH)/host/bench_simavr
+BENCH_RUNNER_FLAGS := -m $(MCU) -f $(F_CPU) -c $(BENCH_MAX_CYCLES)
+ifneq ($(BENCH_LOOPBACK), )
+BENCH_RUNNER_FLAGS += -l $(BENCH_LOOPBACK)
+endif
+
+# Output messages
+MSG_BENCH_CMD      := ' [SIMAVR]  :'
+
+$(BENCH_RUNNER): $(BENCH_RUNNER).c
+	@echo $(MSG_BENCH_CMD) Building simulator runner \"$(notdir $@)\"
+	$(BENCH_HOST_CC) -O2 -Wall $(BENCH_SIMAVR_CFLAGS) $< -o $@ $(BENCH_SIMAVR_LIBS)
+
+# Runs the firmware in simavr and writes the measured cycle counts as CSV.
+# Commit the CSV file together with library changes, so regressions show up in review.
+bench: $(TARGET).elf $(BENCH_RUNNER)
+	@echo $(MSG_BENCH_CMD) Running \"$(TARGET).elf\" and writing results to \"$(BENCH_OUTPUT)\"
+	$(BENCH_RUNNER) $(BENCH_RUNNER_FLAGS) -o $(BENCH_OUTPUT) $(TARGET).elf
+	@cat $(BENCH_OUTPUT)
+
+# Phony build targets for this module
+.PHONY: $(DMBS_BUILD_TARGETS)
+
+endif
@@ -0,0 +1,48 @@
+# Copyright (c) 2018 NicoHood
+# See the readme for credit to other people.
+#
+# Permission is hereby granted, free of charge, to any person obtaining a copy
+# of this software and associated documentation files (the "Software"), to deal
+# in the Software without restriction, including without limitation the rights
+# to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+# copies of the Software, and to permit persons to whom the Software is
+# furnished to do so, subject to the following conditions:
+#
+# The above copyright notice and this permission notice shall be included in
+# all copies or substantial portions of the Software.
+#
+# THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+# IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+# FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+# AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+# LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+# OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+# THE SOFTWARE.
+
+# Compares two bench results side by side.
+# Usage: awk -f bench_compare.awk before.csv after.csv
+
+BEGIN {
+    FS = ","
+}
+
+# Skip csv header
+$1 == "name" {
+    next
+}
+
+# First results
+FNR == NR {
+    before[$1] = $2
+    next
+}
+
+# Second results
+{
+    if ($1 in before) {
+        printf("%-24s %8d %8d %+8d\n", $1, before[$1], $2, $2 - before[$1])
+    }
+    else {
+        printf("%-24s %8s %8d\n", $1, "-", $2)
+    }
+}
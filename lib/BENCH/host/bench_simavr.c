@@ -0,0 +1,147 @@
+/*
+Copyright (c) 2018 NicoHood
+See the readme for credit to other people.
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+THE SOFTWARE.
+*/
+
+// Host side runner for BENCH firmware.
+// Loads an ELF file into simavr, stores everything the firmware writes into
+// the bench console register (GPIOR0) and stops when the firmware calls bench_exit().
+// Optionally the TX output of an USART is looped back into its RX input.
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include "sim_avr.h"
+#include "sim_elf.h"
+#include "avr_uart.h"
+
+// GPIOR0 data space address (IO address 0x1E) on all supported MCUs
+#define BENCH_CONSOLE_ADDR 0x3E
+
+static void console_write(struct avr_t* avr, avr_io_addr_t addr, uint8_t v, void* param)
+{
+    // Convert carriage returns into regular CSV lines
+    FILE* out = (FILE*)param;
+    fputc(v == '\r' ? '\n' : v, out);
+}
+
+static void usage(const char* name)
+{
+    fprintf(stderr, "Usage: %s -m mcu -f frequency [-c max_cycles] [-l uart] [-o output.csv] firmware.elf\n", name);
+}
+
+int main(int argc, char* argv[])
+{
+    const char* mcu = NULL;
+    const char* output = NULL;
+    uint32_t frequency = 0;
+    uint64_t max_cycles = 100000000ULL;
+    char loopback = 0;
+
+    int opt;
+    while ((opt = getopt(argc, argv, "m:f:c:l:o:")) != -1)
+    {
+        switch (opt)
+        {
+            case 'm':
+                mcu = optarg;
+                break;
+            case 'f':
+                frequency = strtoul(optarg, NULL, 0);
+                break;
+            case 'c':
+                max_cycles = strtoull(optarg, NULL, 0);
+                break;
+            case 'l':
+                loopback = optarg[0];
+                break;
+            case 'o':
+                output = optarg;
+                break;
+            default:
+                usage(argv[0]);
+                return EXIT_FAILURE;
+        }
+    }
+    if (optind >= argc || !mcu || !frequency) {
+        usage(argv[0]);
+        return EXIT_FAILURE;
+    }
+
+    // Load firmware
+    elf_firmware_t firmware;
+    memset(&firmware, 0, sizeof(firmware));
+    if (elf_read_firmware(argv[optind], &firmware)) {
+        fprintf(stderr, "Unable to load firmware \"%s\"\n", argv[optind]);
+        return EXIT_FAILURE;
+    }
+    strncpy(firmware.mmcu, mcu, sizeof(firmware.mmcu) - 1);
+    firmware.frequency = frequency;
+
+    avr_t* avr = avr_make_mcu_by_name(firmware.mmcu);
+    if (!avr) {
+        fprintf(stderr, "Unsupported MCU \"%s\"\n", firmware.mmcu);
+        return EXIT_FAILURE;
+    }
+    avr_init(avr);
+    avr_load_firmware(avr, &firmware);
+
+    // Open output file
+    FILE* out = stdout;
+    if (output) {
+        out = fopen(output, "w");
+        if (!out) {
+            perror(output);
+            return EXIT_FAILURE;
+        }
+    }
+    avr_register_io_write(avr, BENCH_CONSOLE_ADDR, console_write, out);
+
+    // Connect USART TX with RX
+    if (loopback) {
+        avr_irq_t* tx = avr_io_getirq(avr, AVR_IOCTL_UART_GETIRQ(loopback), UART_IRQ_OUTPUT);
+        avr_irq_t* rx = avr_io_getirq(avr, AVR_IOCTL_UART_GETIRQ(loopback), UART_IRQ_INPUT);
+        if (!tx || !rx) {
+            fprintf(stderr, "USART %c not available on %s\n", loopback, firmware.mmcu);
+            return EXIT_FAILURE;
+        }
+        avr_connect_irq(tx, rx);
+    }
+
+    // Run until the firmware goes to sleep with interrupts disabled
+    int state = cpu_Running;
+    while (state != cpu_Done && state != cpu_Crashed)
+    {
+        state = avr_run(avr);
+        if (avr->cycle > max_cycles) {
+            fprintf(stderr, "Benchmark did not finish within %llu cycles\n",
+                    (unsigned long long)max_cycles);
+            state = cpu_Crashed;
+        }
+    }
+
+    if (out != stdout) {
+        fclose(out);
+    }
+    avr_terminate(avr);
+    return (state == cpu_Done) ? EXIT_SUCCESS : EXIT_FAILURE;
+}
@@ -0,0 +1,98 @@
+/*
+Copyright (c) 2018 NicoHood
+See the readme for credit to other people.
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+THE SOFTWARE.
+*/
+
+// Include guard
+#pragma once
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// Software version
+#define BENCH_VERSION 100
+
+#include <stdint.h>
+#include <avr/io.h>
+#include <avr/interrupt.h>
+#include <avr/pgmspace.h>
+
+// Timer1 is used as free running cycle counter without prescaler.
+// A single measurement can therefore cover up to 65534 cycles.
+// Longer measurements are reported as BENCH_OVERFLOW.
+#define BENCH_OVERFLOW UINT16_MAX
+
+// Results are written character by character into this register.
+// The simulator runner intercepts all writes and stores them as CSV.
+#define BENCH_CONSOLE GPIOR0
+
+// Declare an interrupt vector of another module, so it can be called like a function.
+// The vector returns with reti, which enables global interrupts again.
+#define BENCH_DECLARE_ISR(vector) void vector(void) __attribute__((signal))
+
+static inline void bench_start(void) __attribute__((always_inline, unused));
+static inline void bench_start(void)
+{
+    // Restart timer1 from zero without prescaler
+    TCCR1B = 0;
+    TCCR1A = 0;
+    TCNT1 = 0;
+    TIFR1 = (1 << TOV1);
+    TCCR1B = (1 << CS10);
+    asm volatile("" ::: "memory");
+}
+
+static inline uint16_t bench_stop(void) __attribute__((always_inline, unused));
+static inline uint16_t bench_stop(void)
+{
+    asm volatile("" ::: "memory");
+    TCCR1B = 0;
+    if (TIFR1 & (1 << TOV1)) {
+        return BENCH_OVERFLOW;
+    }
+    return TCNT1;
+}
+
+// Global sink to prevent the compiler from optimizing away measured results
+extern volatile uint32_t bench_sink;
+
+// Setup and output functions
+void bench_init(void);
+void bench_report_P(const char* name, uint16_t cycles);
+void bench_exit(void) __attribute__((noreturn));
+
+// Measure the cycles of any statement with interrupts disabled.
+// The start/stop overhead is removed from the result inside bench_report_P().
+#define BENCH(name, ...)                                    \
+    do {                                                    \
+        uint8_t bench_sreg = SREG;                          \
+        cli();                                              \
+        bench_start();                                      \
+        __VA_ARGS__;                                        \
+        uint16_t bench_cycles = bench_stop();               \
+        SREG = bench_sreg;                                  \
+        bench_report_P(PSTR(name), bench_cycles);           \
+    } while (0)
+
+#ifdef __cplusplus
+}
+#endif
@@ -0,0 +1,87 @@
+/*
+Copyright (c) 2018 NicoHood
+See the readme for credit to other people.
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+THE SOFTWARE.
+*/
+
+#include "bench.h"
+#include <stdlib.h>
+#include <avr/sleep.h>
+
+volatile uint32_t bench_sink = 0;
+static uint16_t bench_overhead = 0;
+
+static void bench_putc(char c)
+{
+    BENCH_CONSOLE = c;
+}
+
+static void bench_puts_P(const char* s)
+{
+    char c;
+    while ((c = pgm_read_byte(s)))
+    {
+        bench_putc(c);
+        s++;
+    }
+}
+
+void bench_init(void)
+{
+    // Measure the overhead of starting and stopping the counter itself
+    uint8_t sreg = SREG;
+    cli();
+    bench_start();
+    bench_overhead = bench_stop();
+    SREG = sreg;
+
+    // CSV header. Lines are terminated with a carriage return.
+    bench_puts_P(PSTR("name,cycles\r"));
+}
+
+void bench_report_P(const char* name, uint16_t cycles)
+{
+    // Remove measuring overhead
+    if (cycles != BENCH_OVERFLOW) {
+        cycles -= bench_overhead;
+    }
+
+    char buff[6];
+    utoa(cycles, buff, 10);
+
+    bench_puts_P(name);
+    bench_putc(',');
+    for (char* s = buff; *s; s++) {
+        bench_putc(*s);
+    }
+    bench_putc('\r');
+}
+
+void bench_exit(void)
+{
+    // Sleeping with interrupts disabled stops the simulator gracefully.
+    // On real hardware the MCU just stays asleep.
+    set_sleep_mode(SLEEP_MODE_PWR_DOWN);
+    cli();
+    sleep_enable();
+    while (1) {
+        sleep_cpu();
+    }
+}
@@ -51,7 +51,7 @@ DMBS_BUILD_PROVIDED_MACROS +=
 $(foreach MANDATORY_VAR, $(DMBS_BUILD_MANDATORY_VARS), $(call ERROR_IF_UNSET, $(MANDATORY_VAR)))
 
 # Available boards list
-BOARD_LIST := CUSTOM_BOARD ARDUINO_LEONARDO ARDUINO_MICRO ARDUINO_UNO ARDUINO_NANO ARDUINO_MINI
+BOARD_LIST := CUSTOM_BOARD ARDUINO_LEONARDO ARDUINO_MICRO ARDUINO_UNO ARDUINO_NANO ARDUINO_MINI ARDUINO_MEGA2560
 SORTED_BOARD_LIST    = $(sort $(BOARD_LIST))
 PRINTABLE_BOARD_LIST = $(call CONVERT_TO_PRINTABLE, $(SORTED_BOARD_LIST))
 
@@ -167,6 +167,27 @@ AVRDUDE_LOCK       ?= 0x0F
 # Additional Arduino specific board definition
 CC_FLAGS           += -DAVR_MINI
 
+else ifeq ($(BOARD), ARDUINO_MEGA2560)
+
+# Atmega settings
+MCU                ?= atmega2560
+ARCH               ?= AVR8
+F_CPU              ?= 16000000
+
+# Avrdude settings Arduino USB Bootloader
+AVRDUDE_PORT       ?= /dev/ttyACM0
+AVRDUDE_PROGRAMMER ?= wiring
+AVRDUDE_BAUD       ?= 115200
+
+# Fuses
+AVRDUDE_LFUSE      ?= 0xFF
+AVRDUDE_HFUSE      ?= 0xD8
+AVRDUDE_EFUSE      ?= 0xFD
+AVRDUDE_LOCK       ?= 0x0F
+
+# Additional Arduino specific board definition
+CC_FLAGS           += -DAVR_MEGA2560
+
 else ifeq ($(BOARD), CUSTOM_BOARD)
 # User needs to create a file CustomBoard.h and add it to the include path with CC_FLAGS += -I path
 # This way you can faster switch between options of a regular and a custom board.
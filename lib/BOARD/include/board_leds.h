@@ -69,6 +69,13 @@ extern "C" {
     #define LED_OFF()       PORTB &= ~(1 << PB5)
     #define LED_TOGGLE()    PINB  |=  (1 << PB5)
 
+#elif defined(ARDUINO_MEGA2560)
+    #define LED_BUILTIN     13
+    #define LED_INIT()      DDRB  |=  (1 << PB7)
+    #define LED_ON()        PORTB |=  (1 << PB7)
+    #define LED_OFF()       PORTB &= ~(1 << PB7)
+    #define LED_TOGGLE()    PINB  |=  (1 << PB7)
+
 #else
     #pragma message "Board " STR(BOARD) " Leds not supported. Please define your own board specific leds"
 #endif
@@ -72,6 +72,31 @@ extern "C" {
     #define digitalPinToPCMSK(p)    (((p) <= 7) ? (&PCMSK2) : (((p) <= 13) ? (&PCMSK0) : (((p) <= 21) ? (&PCMSK1) : ((uint8_t *)0))))
     #define digitalPinToPCMSKbit(p) (((p) <= 7) ? (p) : (((p) <= 13) ? ((p) - 8) : ((p) - 14)))
 
+#elif defined(ARDUINO_MEGA2560)
+
+    // Mapping of analog pins as digital I/O
+    #define A0   (54)
+    #define A1   (55)
+    #define A2   (56)
+    #define A3   (57)
+    #define A4   (58)
+    #define A5   (59)
+    #define A6   (60)
+    #define A7   (61)
+    #define A8   (62)
+    #define A9   (63)
+    #define A10  (64)
+    #define A11  (65)
+    #define A12  (66)
+    #define A13  (67)
+    #define A14  (68)
+    #define A15  (69)
+
+    #define digitalPinToPCICR(p)    ((((p) >= 10 && (p) <= 13) || ((p) >= 50 && (p) <= 53) || ((p) >= A8 && (p) <= A15)) ? (&PCICR) : ((uint8_t *)0))
+    #define digitalPinToPCICRbit(p) ((((p) >= A8 && (p) <= A15)) ? 2 : 0)
+    #define digitalPinToPCMSK(p)    ((((p) >= 10 && (p) <= 13) || ((p) >= 50 && (p) <= 53)) ? (&PCMSK0) : (((p) >= A8 && (p) <= A15) ? (&PCMSK2) : ((uint8_t *)0)))
+    #define digitalPinToPCMSKbit(p) (((p) >= 10 && (p) <= 13) ? ((p) - 6) : (((p) >= 50 && (p) <= 53) ? (53 - (p)) : ((p) - A8)))
+
 #else
     #pragma message "Board " STR(BOARD) " Pins not supported. Please define your own board specific pins"
 #endif
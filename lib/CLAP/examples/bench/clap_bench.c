@@ -0,0 +1,48 @@
+/*
+Copyright (c) 2018 NicoHood
+See the readme for credit to other people.
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+THE SOFTWARE.
+*/
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <avr/interrupt.h>
+#include "timer0.h"
+#include "clap.h"
+#include "bench.h"
+
+// The ADC interrupt of the CLAP module is called directly to measure it
+BENCH_DECLARE_ISR(ADC_vect);
+
+int main(void)
+{
+    // Initialize libraries. The ADC interrupt itself stays disabled.
+    timer0_init();
+    clap_init();
+    bench_init();
+
+    // ADC interrupt, processing a single sample
+    BENCH("adc_isr", ADC_vect());
+
+    // Clap evaluation inside the main loop
+    BENCH("clap_read", bench_sink = clap_read());
+
+    bench_exit();
+}
@@ -71,7 +71,7 @@ CC_FLAGS           += -I$(FASTLED_MODULE_PATH)/src
 CC_FLAGS           += -I$(FASTLED_MODULE_PATH)/include
 CC_FLAGS           += -include $(TIMER0_MODULE_PATH)/include/timer0.h
 CC_FLAGS           += -DFASTLED_NO_PINMAP -DFASTLED_NEED_YIELD -Dtimer0_millis=timer0_millis_count
-FastLED.cpp_FLAGS   = -DNEED_CXX_BITS
+FastLED.cpp_FLAGS  += -DNEED_CXX_BITS
 
 # Phony build targets for this module
 .PHONY: $(DMBS_BUILD_TARGETS)
@@ -0,0 +1,77 @@
+# Copyright (c) 2018 NicoHood
+# See the readme for credit to other people.
+#
+# Permission is hereby granted, free of charge, to any person obtaining a copy
+# of this software and associated documentation files (the "Software"), to deal
+# in the Software without restriction, including without limitation the rights
+# to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+# copies of the Software, and to permit persons to whom the Software is
+# furnished to do so, subject to the following conditions:
+#
+# The above copyright notice and this permission notice shall be included in
+# all copies or substantial portions of the Software.
+#
+# THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+# IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+# FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+# AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+# LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+# OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+# THE SOFTWARE.
+
+# Include Guard
+ifeq ($(filter OPTIMIZE, $(DMBS_BUILD_MODULES)),)
+
+# Sanity check user supplied DMBS path
+ifndef DMBS_PATH
+$(error Makefile DMBS_PATH option cannot be blank)
+endif
+
+# Location of the current module
+OPTIMIZE_MODULE_PATH := $(patsubst %/,%,$(dir $(lastword $(MAKEFILE_LIST))))
+
+# Import the CORE module of DMBS
+include $(DMBS_PATH)/core.mk
+
+# This module needs to be included before gcc.mk
+ifneq ($(filter GCC, $(DMBS_BUILD_MODULES)),)
+$(error Include this module before gcc.mk)
+endif
+
+# Default values of optionally user-supplied variables
+OPTIMIZE_PROFILE   ?= N
+OPTIMIZE_HOT_SRC   ?= timer0.c usart_rx.c
+OPTIMIZE_HOT_LEVEL ?= 2
+
+# Help settings
+DMBS_BUILD_MODULES         += OPTIMIZE
+DMBS_BUILD_TARGETS         +=
+DMBS_BUILD_MANDATORY_VARS  += DMBS_PATH
+DMBS_BUILD_OPTIONAL_VARS   += OPTIMIZE_PROFILE OPTIMIZE_HOT_SRC OPTIMIZE_HOT_LEVEL
+DMBS_BUILD_PROVIDED_VARS   +=
+DMBS_BUILD_PROVIDED_MACROS +=
+
+# Sanity check user supplied values
+$(foreach MANDATORY_VAR, $(DMBS_BUILD_MANDATORY_VARS), $(call ERROR_IF_UNSET, $(MANDATORY_VAR)))
+$(call ERROR_IF_NONBOOL, OPTIMIZE_PROFILE)
+$(call ERROR_IF_EMPTY, OPTIMIZE_HOT_LEVEL)
+
+# The profile is opt-in with "make OPTIMIZE_PROFILE=Y". gcc.mk already places
+# every function into its own section and links with --gc-sections.
+# The profile additionally:
+# - Enables link time optimization and linker relaxations (-mrelax)
+# - Places data into separate sections, so unused variables get removed too
+# - Compiles the interrupt heavy hot files with -O2 instead of the global -Os.
+#   The flags are added per file and are also honored by LTO.
+ifeq ($(OPTIMIZE_PROFILE), Y)
+LTO                 = Y
+LINKER_RELAXATIONS  = Y
+CC_FLAGS           += -DDMBS_MODULE_OPTIMIZE
+CC_FLAGS           += -fdata-sections
+$(foreach FILE, $(OPTIMIZE_HOT_SRC), $(eval $(FILE)_FLAGS += -O$(OPTIMIZE_HOT_LEVEL)))
+endif
+
+# Phony build targets for this module
+.PHONY: $(DMBS_BUILD_TARGETS)
+
+endif
@@ -0,0 +1,113 @@
+# Copyright (c) 2018 NicoHood
+# See the readme for credit to other people.
+#
+# Permission is hereby granted, free of charge, to any person obtaining a copy
+# of this software and associated documentation files (the "Software"), to deal
+# in the Software without restriction, including without limitation the rights
+# to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+# copies of the Software, and to permit persons to whom the Software is
+# furnished to do so, subject to the following conditions:
+#
+# The above copyright notice and this permission notice shall be included in
+# all copies or substantial portions of the Software.
+#
+# THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+# IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+# FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+# AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+# LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+# OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+# THE SOFTWARE.
+
+
+# Include Guard
+ifeq ($(filter SIZE_REPORT, $(DMBS_BUILD_MODULES)),)
+
+# Sanity check user supplied DMBS path
+ifndef DMBS_PATH
+$(error Makefile DMBS_PATH option cannot be blank)
+endif
+
+# Location of the current module
+SIZE_REPORT_MODULE_PATH := $(patsubst %/,%,$(dir $(lastword $(MAKEFILE_LIST))))
+
+# Import the CORE module of DMBS
+include $(DMBS_PATH)/core.mk
+
+# Default values of optionally user-supplied variables
+SIZE_REPORT_OUTPUT          ?= size.txt
+SIZE_REPORT_BASELINE        ?= size_baseline.txt
+SIZE_REPORT_FLASH_THRESHOLD ?= 32
+SIZE_REPORT_RAM_THRESHOLD   ?= 8
+SIZE_REPORT_NM              ?= avr-nm
+SIZE_REPORT_SIZE            ?= avr-size
+SIZE_REPORT_CI              ?= $(if $(CI),Y,N)
+
+# Help settings
+DMBS_BUILD_MODULES         += SIZE_REPORT
+DMBS_BUILD_TARGETS         += size-report size-baseline
+DMBS_BUILD_MANDATORY_VARS  += DMBS_PATH TARGET
+DMBS_BUILD_OPTIONAL_VARS   += SIZE_REPORT_OUTPUT SIZE_REPORT_BASELINE
+DMBS_BUILD_OPTIONAL_VARS   += SIZE_REPORT_FLASH_THRESHOLD SIZE_REPORT_RAM_THRESHOLD
+DMBS_BUILD_OPTIONAL_VARS   += SIZE_REPORT_NM SIZE_REPORT_SIZE SIZE_REPORT_CI
+DMBS_BUILD_PROVIDED_VARS   +=
+DMBS_BUILD_PROVIDED_MACROS +=
+
+# Sanity check user supplied values
+$(foreach MANDATORY_VAR, $(DMBS_BUILD_MANDATORY_VARS), $(call ERROR_IF_UNSET, $(MANDATORY_VAR)))
+$(call ERROR_IF_EMPTY, SIZE_REPORT_OUTPUT)
+$(call ERROR_IF_EMPTY, SIZE_REPORT_BASELINE)
+$(call ERROR_IF_EMPTY, SIZE_REPORT_FLASH_THRESHOLD)
+$(call ERROR_IF_EMPTY, SIZE_REPORT_RAM_THRESHOLD)
+$(call ERROR_IF_NONBOOL, SIZE_REPORT_CI)
+
+# Maps the file name of every module source to its DMBS module name.
+# Symbols from other files inside a module directory (headers) are mapped by
+# their path. Everything else with debug information belongs to the application.
+# Symbols without debug information (libc, libgcc, startup code) and padding
+# are accounted as OTHER, so all modules sum up to the avr-size total.
+SIZE_REPORT_MODULES      = $(filter-out SIZE_REPORT, $(DMBS_BUILD_MODULES))
+SIZE_REPORT_MODULE_FILES = $(foreach MODULE, $(SIZE_REPORT_MODULES), \
+                               $(foreach FILE, $($(MODULE)_SRC), $(MODULE)=$(notdir $(FILE))))
+SIZE_REPORT_MODULE_DIRS  = $(foreach MODULE, $(SIZE_REPORT_MODULES), \
+                               $(if $($(MODULE)_MODULE_PATH), $(MODULE)=$(notdir $(patsubst %/,%,$($(MODULE)_MODULE_PATH)))))
+SIZE_REPORT_MODULE_DIRS += $(if $(filter USB, $(SIZE_REPORT_MODULES)), USB=LUFA)
+
+# Output messages
+MSG_SIZE_REPORT_CMD := ' [SIZE]    :'
+
+# Breaks down flash and RAM usage per DMBS module
+$(SIZE_REPORT_OUTPUT): $(TARGET).elf
+	@echo $(MSG_SIZE_REPORT_CMD) Writing per module sizes of \"$(TARGET).elf\" to \"$@\"
+	$(SIZE_REPORT_SIZE) $(TARGET).elf > $@.tmp
+	$(SIZE_REPORT_NM) --size-sort --print-size --line-numbers --demangle $(TARGET).elf >> $@.tmp
+	awk -f $(SIZE_REPORT_MODULE_PATH)/size_report.awk -v target="$(TARGET).elf" \
+		-v files="$(strip $(SIZE_REPORT_MODULE_FILES))" -v dirs="$(strip $(SIZE_REPORT_MODULE_DIRS))" \
+		$@.tmp > $@
+	@rm -f $@.tmp
+
+# Prints the module sizes and fails if a module grew more than the threshold.
+# A missing baseline is an error with SIZE_REPORT_CI=Y (default if $CI is set),
+# so CI never passes without checking for regressions.
+size-report: $(SIZE_REPORT_OUTPUT)
+	@cat $(SIZE_REPORT_OUTPUT)
+	@if [ -f $(SIZE_REPORT_BASELINE) ]; then \
+		awk -f $(SIZE_REPORT_MODULE_PATH)/size_compare.awk \
+			-v flash_threshold=$(SIZE_REPORT_FLASH_THRESHOLD) -v ram_threshold=$(SIZE_REPORT_RAM_THRESHOLD) \
+			$(SIZE_REPORT_BASELINE) $(SIZE_REPORT_OUTPUT); \
+	elif [ "$(SIZE_REPORT_CI)" = "Y" ]; then \
+		echo $(MSG_SIZE_REPORT_CMD) No \"$(SIZE_REPORT_BASELINE)\" found, create and commit it with \"make size-baseline\"; \
+		exit 1; \
+	else \
+		echo $(MSG_SIZE_REPORT_CMD) No \"$(SIZE_REPORT_BASELINE)\" found, run \"make size-baseline\" to create it; \
+	fi
+
+# Stores the current sizes as new baseline, which should be committed
+size-baseline: $(SIZE_REPORT_OUTPUT)
+	@echo $(MSG_SIZE_REPORT_CMD) Updating \"$(SIZE_REPORT_BASELINE)\"
+	cp $(SIZE_REPORT_OUTPUT) $(SIZE_REPORT_BASELINE)
+
+# Phony build targets for this module
+.PHONY: $(DMBS_BUILD_TARGETS)
+
+endif
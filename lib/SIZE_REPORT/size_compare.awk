@@ -0,0 +1,61 @@
+# Copyright (c) 2018 NicoHood
+# See the readme for credit to other people.
+#
+# Permission is hereby granted, free of charge, to any person obtaining a copy
+# of this software and associated documentation files (the "Software"), to deal
+# in the Software without restriction, including without limitation the rights
+# to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+# copies of the Software, and to permit persons to whom the Software is
+# furnished to do so, subject to the following conditions:
+#
+# The above copyright notice and this permission notice shall be included in
+# all copies or substantial portions of the Software.
+#
+# THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+# IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+# FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+# AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+# LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+# OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+# THE SOFTWARE.
+
+# Compares a size report against its baseline.
+# Usage: awk -f size_compare.awk -v flash_threshold=N -v ram_threshold=N baseline current
+# Exits with 1 if any module grew by more than the given thresholds.
+
+/^#/ || $1 == "MODULE" || NF != 3 {
+    next
+}
+
+# Baseline
+FNR == NR {
+    base_flash[$1] = $2
+    base_ram[$1] = $3
+    next
+}
+
+# Current report
+{
+    diff_flash = $2 - base_flash[$1]
+    diff_ram = $3 - base_ram[$1]
+    status = ""
+    if (diff_flash > flash_threshold + 0) {
+        status = status " FLASH"
+    }
+    if (diff_ram > ram_threshold + 0) {
+        status = status " RAM"
+    }
+    if (status != "" && $1 != "TOTAL") {
+        failed = 1
+        status = "  <-- exceeds threshold:" status
+    }
+    printf("%-16s %+8d %+8d%s\n", $1, diff_flash, diff_ram, status)
+}
+
+END {
+    if (failed) {
+        printf("Size regression: threshold is %d bytes flash, %d bytes RAM per module\n",
+               flash_threshold, ram_threshold)
+        exit 1
+    }
+}
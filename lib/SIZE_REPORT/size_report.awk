@@ -0,0 +1,140 @@
+# Copyright (c) 2018 NicoHood
+# See the readme for credit to other people.
+#
+# Permission is hereby granted, free of charge, to any person obtaining a copy
+# of this software and associated documentation files (the "Software"), to deal
+# in the Software without restriction, including without limitation the rights
+# to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+# copies of the Software, and to permit persons to whom the Software is
+# furnished to do so, subject to the following conditions:
+#
+# The above copyright notice and this permission notice shall be included in
+# all copies or substantial portions of the Software.
+#
+# THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+# IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+# FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+# AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+# LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+# OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+# THE SOFTWARE.
+
+# Attributes flash and RAM usage to DMBS modules.
+# Input: avr-size (berkeley format) output, followed by
+#        avr-nm --size-sort --print-size --line-numbers output.
+# Variables:
+#   target  Name of the elf file for the report header
+#   files   Space separated list of MODULE=source.c pairs
+#   dirs    Space separated list of MODULE=directory pairs
+
+function hex(s,    i, n)
+{
+    n = 0
+    s = tolower(s)
+    for (i = 1; i <= length(s); i++) {
+        n = n * 16 + index("0123456789abcdef", substr(s, i, 1)) - 1
+    }
+    return n
+}
+
+function module_of(location,    path, name, i)
+{
+    # Symbols without debug information
+    if (location == "") {
+        return "OTHER"
+    }
+
+    # Remove line number, then check the source file name first
+    path = location
+    sub(/:[0-9?]*$/, "", path)
+    name = path
+    sub(/^.*\//, "", name)
+    if (name in file_module) {
+        return file_module[name]
+    }
+
+    # Headers and other files inside a module directory
+    for (i = 1; i <= dir_count; i++) {
+        if (index(path, "/" dir_name[i] "/")) {
+            return dir_module[i]
+        }
+    }
+    return "APP"
+}
+
+BEGIN {
+    n = split(files, pairs, " ")
+    for (i = 1; i <= n; i++) {
+        split(pairs[i], kv, "=")
+        file_module[kv[2]] = kv[1]
+    }
+    dir_count = split(dirs, pairs, " ")
+    for (i = 1; i <= dir_count; i++) {
+        split(pairs[i], kv, "=")
+        dir_module[i] = kv[1]
+        dir_name[i] = kv[2]
+    }
+}
+
+# avr-size header and totals
+$1 == "text" {
+    next
+}
+$1 ~ /^[0-9]+$/ && $3 ~ /^[0-9]+$/ {
+    total_flash = $1 + $2
+    total_ram = $2 + $3
+    next
+}
+
+# avr-nm: "address size type name<TAB>file:line"
+NF >= 4 && $3 ~ /^[A-Za-z]$/ {
+    split($0, parts, "\t")
+    location = (2 in parts) ? parts[2] : ""
+    size = hex($2)
+    type = $3
+    module = module_of(location)
+    if (module == "OTHER") {
+        next
+    }
+    seen[module] = 1
+
+    # RAM symbols are located at 0x800000, EEPROM at 0x810000
+    if (substr($1, length($1) - 5, 2) == "80" && length($1) >= 6) {
+        ram[module] += size
+        # Initialized data is also stored in flash
+        if (type !~ /^[bB]$/) {
+            flash[module] += size
+        }
+    }
+    else if (substr($1, length($1) - 5, 2) != "81" || length($1) < 6) {
+        flash[module] += size
+    }
+}
+
+END {
+    printf("# Flash and RAM usage of %s per DMBS module in bytes\n", target)
+    printf("%-16s %8s %8s\n", "MODULE", "FLASH", "RAM")
+
+    # Print modules in alphabetical order
+    count = 0
+    for (module in seen) {
+        sorted[++count] = module
+    }
+    for (i = 2; i <= count; i++) {
+        for (j = i; j > 1 && sorted[j - 1] > sorted[j]; j--) {
+            tmp = sorted[j]; sorted[j] = sorted[j - 1]; sorted[j - 1] = tmp
+        }
+    }
+    sum_flash = 0
+    sum_ram = 0
+    for (i = 1; i <= count; i++) {
+        module = sorted[i]
+        printf("%-16s %8d %8d\n", module, flash[module], ram[module])
+        sum_flash += flash[module]
+        sum_ram += ram[module]
+    }
+
+    # Remaining bytes without debug information
+    printf("%-16s %8d %8d\n", "OTHER", total_flash - sum_flash, total_ram - sum_ram)
+    printf("%-16s %8d %8d\n", "TOTAL", total_flash, total_ram)
+}
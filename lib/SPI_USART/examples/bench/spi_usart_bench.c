@@ -0,0 +1,42 @@
+/*
+Copyright (c) 2018 NicoHood
+See the readme for credit to other people.
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+THE SOFTWARE.
+*/
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "spi_usart.h"
+#include "bench.h"
+
+int main(void)
+{
+    // Initialize libraries
+    spi_usart_init();
+    bench_init();
+
+    // Single byte and buffer transfers
+    uint8_t data[16] = { 0 };
+    BENCH("spi_usart_transfer_8", bench_sink = spi_usart_transfer_8(0x55));
+    BENCH("spi_usart_transfer", spi_usart_transfer(data, sizeof(data)));
+    BENCH("spi_usart_transfer_msb", spi_usart_transfer_msb(data, sizeof(data)));
+
+    bench_exit();
+}
@@ -56,7 +56,7 @@ TIMER0_SRC := $(TIMER0_MODULE_PATH)/src/timer0.c
 SRC                += $(TIMER0_SRC)
 CC_FLAGS           += -DDMBS_MODULE_TIMER0
 CC_FLAGS           += -I$(TIMER0_MODULE_PATH)/include
-timer0.c_FLAGS      = -fno-lto
+timer0.c_FLAGS     += -fno-lto
 
 # Phony build targets for this module
 .PHONY: $(DMBS_BUILD_TARGETS)
@@ -0,0 +1,67 @@
+/*
+Copyright (c) 2018 NicoHood
+See the readme for credit to other people.
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+THE SOFTWARE.
+*/
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <avr/interrupt.h>
+#include "usart.h"
+#include "bench.h"
+
+// The RX interrupt of the USART module is called directly to measure it
+#if defined(__AVR_ATmega32U4__) || defined(__AVR_ATmega16U4__)
+#define BENCH_USART_RX_VECT USART1_RX_vect
+#else
+#define BENCH_USART_RX_VECT USART_RX_vect
+#endif
+BENCH_DECLARE_ISR(BENCH_USART_RX_VECT);
+
+int main(void)
+{
+    // Initialize libraries
+    usart_init();
+    bench_init();
+
+    // Transmit a byte with an empty buffer, which writes directly to UDR
+    BENCH("usart_putchar", usart_putchar('A'));
+
+    // Transmit a byte while the hardware is still busy, which uses the buffer
+    BENCH("usart_putchar_buffered", usart_putchar('B'));
+
+    // Wait until both bytes are looped back by the simulator
+    usart_flush();
+    sei();
+    while (usart_avail_read() < 2);
+    cli();
+
+    // Read a single byte from the RX buffer
+    BENCH("usart_getchar", bench_sink = usart_getchar());
+
+    // Receive interrupt, storing a new byte into the RX buffer
+    BENCH("usart_rx_isr", BENCH_USART_RX_VECT());
+
+    // Read a full buffer
+    uint8_t data[USART_BUFFER_RX];
+    BENCH("usart_read", bench_sink = usart_read(data, sizeof(data)));
+
+    bench_exit();
+}
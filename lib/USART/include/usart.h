@@ -74,6 +74,11 @@ int usart_peek(void) USART_DEPRECIATED;
 uint8_t usart_avail_read(void) USART_DEPRECIATED;
 size_t usart_read(uint8_t* buff, size_t len);
 
+// Zero copy receive. Returns the number of contiguous bytes at *data, which
+// stay valid until they are released. May be less than usart_avail_read().
+uint8_t usart_read_borrow(const uint8_t** data) USART_DEPRECIATED;
+void usart_read_release(uint8_t len) USART_DEPRECIATED;
+
 #ifdef __cplusplus
 }
 #endif
@@ -200,6 +200,50 @@ int usart_fgetc(FILE *stream);
 #define USART_TX_HIGH()     PORTD |= (1 << PD1)
 #define USART_TX_LOW()      PORTD &= ~(1 << PD1)
 
+#elif defined(__AVR_ATmega2560__) || defined(__AVR_ATmega1280__)
+
+// Register mapping
+#define USART_UBRRH         UBRR0H
+#define USART_UBRRL         UBRR0L
+#define USART_UCSRA         UCSR0A
+#define USART_UCSRB         UCSR0B
+#define USART_UCSRC         UCSR0C
+#define USART_UDR           UDR0
+
+// Bit mapping UCSRnA
+#define USART_RXC           RXC0
+#define USART_TXC           TXC0
+#define USART_UDRE          UDRE0
+#define USART_UPE           UPE0
+#define USART_U2X           U2X0
+
+// Bit mapping UCSRnB
+#ifndef URSEL
+#undef USART_URSEL
+#else
+#define USART_URSEL         URSEL
+#endif
+#define USART_RXCIE         RXCIE0
+#define USART_UDRIE         UDRIE0
+#define USART_RXEN          RXEN0
+#define USART_TXEN          TXEN0
+
+// Bit mapping UCSRnC
+#define USART_UPM0          UPM00
+#define USART_UPM1          UPM01
+#define USART_USBS          USBS0
+#define USART_UCSZ0         UCSZ00
+#define USART_UCSZ1         UCSZ01
+#define USART_UCSZ2         UCSZ02
+
+// Interrupt vectors
+#define USART_RX_VECT       USART0_RX_vect
+#define USART_UDRE_VECT     USART0_UDRE_vect
+
+// TX/RX pin functions
+#define USART_TX_HIGH()     PORTE |= (1 << PE1)
+#define USART_TX_LOW()      PORTE &= ~(1 << PE1)
+
 #else
 #error "Unsupported MCU"
 #endif
@@ -99,6 +99,26 @@ uint8_t usart_avail_read(void)
         (uint8_t)usart_buffer_rx_head) % (uint8_t)USART_BUFFER_RX);
 }
 
+uint8_t usart_read_borrow(const uint8_t** data)
+{
+    // Return the data until the head or the end of the ring buffer.
+    // The ISR never writes between tail and head, so no copy is required.
+    uint8_t head = usart_buffer_rx_head;
+    uint8_t tail = usart_buffer_rx_tail;
+    *data = (const uint8_t*)&usart_buffer_rx[tail];
+    return (uint8_t)((head >= tail) ? head : (uint8_t)USART_BUFFER_RX) - tail;
+}
+
+void usart_read_release(uint8_t len)
+{
+    // Free the borrowed space for the ISR
+    uint8_t avail = usart_avail_read();
+    if (len > avail) {
+        len = avail;
+    }
+    usart_buffer_rx_tail = (uint8_t)(((uint16_t)usart_buffer_rx_tail + len) % USART_BUFFER_RX);
+}
+
 #else // !(USART_BUFFER_RX)
 int usart_getchar(void)
 {
@@ -125,6 +145,18 @@ uint8_t usart_avail_read(void)
     }
     return 0;
 }
+
+uint8_t usart_read_borrow(const uint8_t** data)
+{
+    // Impossible without buffers
+    *data = NULL;
+    return 0;
+}
+
+void usart_read_release(uint8_t len)
+{
+    // Nothing was borrowed
+}
 #endif
 
 size_t usart_read(uint8_t* buff, size_t len)
@@ -132,6 +164,34 @@ size_t usart_read(uint8_t* buff, size_t len)
     // Read data into preallocated buffer. len should normally not be > USART_BUFFER_RX
     // Should be user along with usart_avail_read() to determine available byte count.
     size_t count = 0;
+#if (USART_BUFFER_RX)
+    // Copy all available data in (at most two) contiguous chunks.
+    // No atomic block required as 1byte access is already atomic
+    // and the ISR only writes the head, while the tail is only written here.
+    uint8_t head = usart_buffer_rx_head;
+    uint8_t tail = usart_buffer_rx_tail;
+    while (len && (tail != head))
+    {
+        // Copy until the head or the end of the ring buffer
+        uint8_t chunk = (uint8_t)((head > tail) ? head : (uint8_t)USART_BUFFER_RX) - tail;
+        if (chunk > len) {
+            chunk = len;
+        }
+        len -= chunk;
+        count += chunk;
+        while (chunk--) {
+            *buff++ = usart_buffer_rx[tail++];
+        }
+
+        // Wrap around
+        if (tail >= (uint8_t)USART_BUFFER_RX) {
+            tail = 0;
+        }
+    }
+
+    // Free the space for the ISR
+    usart_buffer_rx_tail = tail;
+#else
     while(len--)
     {
         int c = usart_getchar();
@@ -143,6 +203,7 @@ size_t usart_read(uint8_t* buff, size_t len)
         buff++;
         count++;
     }
+#endif
     return count;
 }
 
@@ -44,11 +44,15 @@ ifneq ($(filter GCC, $(DMBS_BUILD_MODULES)),)
 $(error Include this module before gcc.mk)
 endif
 
+# Default values of optionally user-supplied variables
+USB_DEFERRED_TASKS  ?=
+USB_SOF_PROFILE     ?=
+
 # Help settings
 DMBS_BUILD_MODULES         += USB
 DMBS_BUILD_TARGETS         +=
 DMBS_BUILD_MANDATORY_VARS  += DMBS_PATH
-DMBS_BUILD_OPTIONAL_VARS   +=
+DMBS_BUILD_OPTIONAL_VARS   += USB_DEFERRED_TASKS USB_SOF_PROFILE
 DMBS_BUILD_PROVIDED_VARS   += USB_SRC
 DMBS_BUILD_PROVIDED_MACROS +=
 
@@ -67,6 +71,14 @@ CC_FLAGS           += -DDMBS_MODULE_USB
 CC_FLAGS           += -I$(USB_MODULE_PATH)/include
 CC_FLAGS           += -DUSE_LUFA_CONFIG_HEADER
 
+# Optional settings
+ifneq ($(USB_DEFERRED_TASKS), )
+CC_FLAGS           += -DUSB_DEFERRED_TASKS=$(USB_DEFERRED_TASKS)
+endif
+ifneq ($(USB_SOF_PROFILE), )
+CC_FLAGS           += -DUSB_SOF_PROFILE=$(USB_SOF_PROFILE)
+endif
+
 # Phony build targets for this module
 .PHONY: $(DMBS_BUILD_TARGETS)
 
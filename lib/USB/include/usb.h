@@ -30,6 +30,25 @@ extern "C" {
 // Software version
 #define USB_VERSION 100
 
+// Run the class tasks (HID reports, CDC buffers) from usb_task() in the main
+// loop instead of the start of frame interrupt. The interrupt then only counts
+// frames, which keeps TIMER0 and USART interrupts on time. The main loop must
+// call usb_task() at least once per millisecond to keep the full USB speed.
+#ifndef USB_DEFERRED_TASKS
+#define USB_DEFERRED_TASKS 0
+#endif
+
+// Frames to catch up at most if usb_task() was not called for a while
+#ifndef USB_TASK_MAX_FRAMES
+#define USB_TASK_MAX_FRAMES 8
+#endif
+
+// Record the worst case duration of the start of frame interrupt, see usb_sof_cycles_max().
+// Timer1 is read as cycle counter, so it must run without prescaler.
+#ifndef USB_SOF_PROFILE
+#define USB_SOF_PROFILE 0
+#endif
+
 	/* Includes: */
 		#include <avr/io.h>
 		#include <avr/wdt.h>
@@ -49,6 +68,9 @@ extern "C" {
 #ifdef DMBS_MODULE_USB_CDC_SERIAL
         extern USB_ClassInfo_CDC_Device_t VirtualSerial_CDC_Interface;
 #endif
+#ifdef DMBS_MODULE_USB_RAW_HID
+        extern USB_ClassInfo_HID_Device_t RawHID_HID_Interface;
+#endif
 
 	/* Function Prototypes: */
 		void EVENT_USB_Device_Connect(void);
@@ -57,10 +79,17 @@ extern "C" {
 		void EVENT_USB_Device_ControlRequest(void);
 		void EVENT_USB_Device_StartOfFrame(void);
 
+		void usb_task(void);
+		uint16_t usb_sof_cycles_max(void);
+
 #ifdef DMBS_MODULE_USB_KEYBOARD
-        bool CALLBACK_HID_Keyboard_CreateHIDReport(USB_KeyboardReport_Data_t* ReportData);
+        bool usb_keyboard_configure(void);
+        bool CALLBACK_HID_Keyboard_CreateHIDReport(uint8_t* ReportData, uint16_t* const ReportSize);
         void CALLBACK_HID_Keyboard_ProcessHIDReport(uint8_t* leds);
-        bool CALLBACK_HID_Device_CreateHIDReport(USB_ClassInfo_HID_Device_t* const HIDInterfaceInfo,
+#endif
+
+#if defined(DMBS_MODULE_USB_KEYBOARD) || defined(DMBS_MODULE_USB_RAW_HID)
+		bool CALLBACK_HID_Device_CreateHIDReport(USB_ClassInfo_HID_Device_t* const HIDInterfaceInfo,
 		                                         uint8_t* const ReportID,
 		                                         const uint8_t ReportType,
 		                                         void* ReportData,
@@ -72,9 +101,22 @@ extern "C" {
 		                                          const uint16_t ReportSize);
 #endif
 
+#ifdef DMBS_MODULE_USB_RAW_HID
+        bool usb_raw_hid_configure(void);
+        void usb_raw_hid_task(void);
+        bool CALLBACK_HID_RawHID_CreateHIDReport(uint8_t* ReportData, uint16_t* const ReportSize);
+        void CALLBACK_HID_RawHID_ProcessHIDReport(const uint8_t* ReportData, uint16_t ReportSize);
+#endif
+
+#ifdef DMBS_MODULE_USB_MIDI
+        bool usb_midi_configure(void);
+        void usb_midi_task(void);
+#endif
+
 #ifdef DMBS_MODULE_USB_CDC_SERIAL
         void usb_cdc_serial_init(void);
         void CDC_Device_MillisecondElapsed(void);
+        void usb_cdc_serial_task(void);
 #endif
 
 #ifdef __cplusplus
@@ -29,36 +29,136 @@ THE SOFTWARE.
 		#include <LUFA/Drivers/USB/USB.h>
 
 	/* Macros: */
+		// Interfaces and endpoints are numbered in the order of the enabled modules.
+		// Every module starts after the previous one, so the endpoints are ascending
+		// in the order usb.c configures them, as required by ORDERED_EP_CONFIG.
+		// Add new modules at the end of the chain and to the totals below.
+
+		// Endpoint FIFO memory of the MCU. Endpoint 1 of the bigger devices
+		// has up to 256 bytes, all other endpoints up to 64 bytes.
+#if defined(__AVR_ATmega32U4__) || defined(__AVR_ATmega16U4__) || \
+    defined(__AVR_AT90USB1286__) || defined(__AVR_AT90USB1287__) || \
+    defined(__AVR_AT90USB646__) || defined(__AVR_AT90USB647__)
+		#define USB_FIFO_SIZE                  832
+		#define USB_EP_MAX_SIZE(ep)            (((ep) == 1) ? 256 : 64)
+#else
+		#define USB_FIFO_SIZE                  176
+		#define USB_EP_MAX_SIZE(ep)            64
+#endif
+
+		#define USB_CDC_SERIAL_FIRST_INTERFACE 0
+		#define USB_CDC_SERIAL_FIRST_ENDPOINT  1
 #ifdef DMBS_MODULE_USB_CDC_SERIAL
-		/** Endpoint address of the CDC device-to-host notification IN endpoint. */
-		#define CDC_NOTIFICATION_EPADDR        (ENDPOINT_DIR_IN  | 3)
+		#define USB_CDC_SERIAL_INTERFACES      2
+		#define USB_CDC_SERIAL_ENDPOINTS       3
 
 		/** Endpoint address of the CDC device-to-host data IN endpoint. */
-		#define CDC_TX_EPADDR                  (ENDPOINT_DIR_IN  | 1)
+		#define CDC_TX_EPADDR                  (ENDPOINT_DIR_IN  | (USB_CDC_SERIAL_FIRST_ENDPOINT + 0))
 
 		/** Endpoint address of the CDC host-to-device data OUT endpoint. */
-		#define CDC_RX_EPADDR                  (ENDPOINT_DIR_OUT | 2)
+		#define CDC_RX_EPADDR                  (ENDPOINT_DIR_OUT | (USB_CDC_SERIAL_FIRST_ENDPOINT + 1))
+
+		/** Endpoint address of the CDC device-to-host notification IN endpoint. */
+		#define CDC_NOTIFICATION_EPADDR        (ENDPOINT_DIR_IN  | (USB_CDC_SERIAL_FIRST_ENDPOINT + 2))
 
 		/** Size in bytes of the CDC device-to-host notification IN endpoint. */
 		#define CDC_NOTIFICATION_EPSIZE        8
 
-		/** Size in bytes of the CDC data IN and OUT endpoints. */
+		/** Size in bytes and number of banks of the CDC data IN and OUT endpoints. */
 		#define CDC_TXRX_EPSIZE                64
+		#define CDC_TXRX_BANKS                 2
+
+		#define USB_CDC_SERIAL_FIFO            (2 * CDC_TXRX_BANKS * CDC_TXRX_EPSIZE + CDC_NOTIFICATION_EPSIZE)
+#else
+		#define USB_CDC_SERIAL_INTERFACES      0
+		#define USB_CDC_SERIAL_ENDPOINTS       0
+		#define USB_CDC_SERIAL_FIFO            0
 #endif
 
+		#define USB_KEYBOARD_FIRST_INTERFACE   (USB_CDC_SERIAL_FIRST_INTERFACE + USB_CDC_SERIAL_INTERFACES)
+		#define USB_KEYBOARD_FIRST_ENDPOINT    (USB_CDC_SERIAL_FIRST_ENDPOINT + USB_CDC_SERIAL_ENDPOINTS)
 #ifdef DMBS_MODULE_USB_KEYBOARD
+		#define USB_KEYBOARD_INTERFACES        1
+		#define USB_KEYBOARD_ENDPOINTS         1
+
 		/** Endpoint address of the Keyboard HID reporting IN endpoint. */
-#ifdef DMBS_MODULE_USB_CDC_SERIAL
-		#define KEYBOARD_EPADDR                (ENDPOINT_DIR_IN  | 4)
-#else
-        // Move Keyboard to the first EP, because ORDERED_EP_CONFIG is enabled.
-        #define KEYBOARD_EPADDR                (ENDPOINT_DIR_IN  | 1)
-#endif
+		#define KEYBOARD_EPADDR                (ENDPOINT_DIR_IN  | USB_KEYBOARD_FIRST_ENDPOINT)
+
+#if defined(USB_KEYBOARD_NKRO) && (USB_KEYBOARD_NKRO)
+		/** Number of keys in the N-key rollover bitmap, usages 0x00 - 0x77. */
+		#define USB_KEYBOARD_NKRO_KEYS         120
 
+		/** Size in bytes of the Keyboard HID reporting IN endpoint, modifiers and bitmap. */
+		#define KEYBOARD_EPSIZE                16
+#else
 		/** Size in bytes of the Keyboard HID reporting IN endpoint. */
 		#define KEYBOARD_EPSIZE                8
 #endif
 
+		#define USB_KEYBOARD_FIFO              KEYBOARD_EPSIZE
+#else
+		#define USB_KEYBOARD_INTERFACES        0
+		#define USB_KEYBOARD_ENDPOINTS         0
+		#define USB_KEYBOARD_FIFO              0
+#endif
+
+		#define USB_RAW_HID_FIRST_INTERFACE    (USB_KEYBOARD_FIRST_INTERFACE + USB_KEYBOARD_INTERFACES)
+		#define USB_RAW_HID_FIRST_ENDPOINT     (USB_KEYBOARD_FIRST_ENDPOINT + USB_KEYBOARD_ENDPOINTS)
+#ifdef DMBS_MODULE_USB_RAW_HID
+		#define USB_RAW_HID_INTERFACES         1
+		#define USB_RAW_HID_ENDPOINTS          2
+
+		/** Endpoint addresses of the raw HID reporting IN and OUT endpoints. */
+		#define RAW_HID_IN_EPADDR              (ENDPOINT_DIR_IN  | (USB_RAW_HID_FIRST_ENDPOINT + 0))
+		#define RAW_HID_OUT_EPADDR             (ENDPOINT_DIR_OUT | (USB_RAW_HID_FIRST_ENDPOINT + 1))
+
+		/** Size in bytes of the raw HID reporting IN and OUT endpoints. */
+		#define RAW_HID_EPSIZE                 64
+
+		#define USB_RAW_HID_FIFO               (2 * RAW_HID_EPSIZE)
+#else
+		#define USB_RAW_HID_INTERFACES         0
+		#define USB_RAW_HID_ENDPOINTS          0
+		#define USB_RAW_HID_FIFO               0
+#endif
+
+		#define USB_MIDI_FIRST_INTERFACE       (USB_RAW_HID_FIRST_INTERFACE + USB_RAW_HID_INTERFACES)
+		#define USB_MIDI_FIRST_ENDPOINT        (USB_RAW_HID_FIRST_ENDPOINT + USB_RAW_HID_ENDPOINTS)
+#ifdef DMBS_MODULE_USB_MIDI
+		#define USB_MIDI_INTERFACES            2
+		#define USB_MIDI_ENDPOINTS             2
+
+		/** Endpoint addresses of the MIDI stream IN and OUT endpoints. */
+		#define MIDI_STREAM_IN_EPADDR          (ENDPOINT_DIR_IN  | (USB_MIDI_FIRST_ENDPOINT + 0))
+		#define MIDI_STREAM_OUT_EPADDR         (ENDPOINT_DIR_OUT | (USB_MIDI_FIRST_ENDPOINT + 1))
+
+		/** Size in bytes and number of banks of the MIDI stream IN and OUT endpoints.
+		 *  Double banks, if the FIFO has space for them, let the host take a packet
+		 *  while the next one gets filled.
+		 */
+		#define MIDI_STREAM_EPSIZE             64
+		#define MIDI_STREAM_BANKS              ((USB_FIFO_SIZE > 176) ? 2 : 1)
+
+		#define USB_MIDI_FIFO                  (2 * MIDI_STREAM_BANKS * MIDI_STREAM_EPSIZE)
+#else
+		#define USB_MIDI_INTERFACES            0
+		#define USB_MIDI_ENDPOINTS             0
+		#define USB_MIDI_FIFO                  0
+#endif
+
+		// Totals of all enabled modules
+		#define USB_INTERFACE_COUNT            (USB_MIDI_FIRST_INTERFACE + USB_MIDI_INTERFACES)
+		#define USB_ENDPOINT_COUNT             (USB_MIDI_FIRST_ENDPOINT + USB_MIDI_ENDPOINTS)
+		#define USB_FIFO_USED                  (FIXED_CONTROL_ENDPOINT_SIZE + USB_CDC_SERIAL_FIFO + \
+		                                        USB_KEYBOARD_FIFO + USB_RAW_HID_FIFO + USB_MIDI_FIFO)
+
+		// CDC needs an interface association if it is combined with other interfaces
+#if defined(DMBS_MODULE_USB_CDC_SERIAL) && (USB_INTERFACE_COUNT > USB_CDC_SERIAL_INTERFACES)
+		#define USB_CDC_SERIAL_IAD             1
+#else
+		#define USB_CDC_SERIAL_IAD             0
+#endif
+
 	/* Type Defines: */
 		/** Type define for the device configuration descriptor structure. This must be defined in the
 		 *  application code, as the configuration descriptor contains several sub-descriptors which
@@ -69,7 +169,7 @@ THE SOFTWARE.
 			USB_Descriptor_Configuration_Header_t    Config;
 
 			// CDC Control Interface
-#if defined(DMBS_MODULE_USB_CDC_SERIAL) && defined(DMBS_MODULE_USB_KEYBOARD)
+#if (USB_CDC_SERIAL_IAD)
 			USB_Descriptor_Interface_Association_t   CDC_IAD;
 #endif
 #ifdef DMBS_MODULE_USB_CDC_SERIAL
@@ -91,6 +191,32 @@ THE SOFTWARE.
 			USB_HID_Descriptor_HID_t                 HID_KeyboardHID;
 	        USB_Descriptor_Endpoint_t                HID_ReportINEndpoint;
 #endif
+
+#ifdef DMBS_MODULE_USB_RAW_HID
+			// Raw HID Interface
+			USB_Descriptor_Interface_t               RawHID_Interface;
+			USB_HID_Descriptor_HID_t                 RawHID_HID;
+			USB_Descriptor_Endpoint_t                RawHID_ReportINEndpoint;
+			USB_Descriptor_Endpoint_t                RawHID_ReportOUTEndpoint;
+#endif
+
+#ifdef DMBS_MODULE_USB_MIDI
+			// MIDI Audio Control Interface
+			USB_Descriptor_Interface_t                Audio_ControlInterface;
+			USB_Audio_Descriptor_Interface_AC_t       Audio_ControlInterface_SPC;
+
+			// MIDI Audio Streaming Interface
+			USB_Descriptor_Interface_t                Audio_StreamInterface;
+			USB_MIDI_Descriptor_AudioInterface_AS_t   Audio_StreamInterface_SPC;
+			USB_MIDI_Descriptor_InputJack_t           MIDI_In_Jack_Emb;
+			USB_MIDI_Descriptor_InputJack_t           MIDI_In_Jack_Ext;
+			USB_MIDI_Descriptor_OutputJack_t          MIDI_Out_Jack_Emb;
+			USB_MIDI_Descriptor_OutputJack_t          MIDI_Out_Jack_Ext;
+			USB_Audio_Descriptor_StreamEndpoint_Std_t MIDI_In_Jack_Endpoint;
+			USB_MIDI_Descriptor_Jack_Endpoint_t       MIDI_In_Jack_Endpoint_SPC;
+			USB_Audio_Descriptor_StreamEndpoint_Std_t MIDI_Out_Jack_Endpoint;
+			USB_MIDI_Descriptor_Jack_Endpoint_t       MIDI_Out_Jack_Endpoint_SPC;
+#endif
 		} USB_Descriptor_Configuration_t;
 
 		/** Enum for the device interface descriptor IDs within the device. Each interface descriptor
@@ -100,11 +226,18 @@ THE SOFTWARE.
 		enum InterfaceDescriptors_t
 		{
 #ifdef DMBS_MODULE_USB_CDC_SERIAL
-			INTERFACE_ID_CDC_CCI  = 0, /**< CDC CCI interface descriptor ID */
-			INTERFACE_ID_CDC_DCI  = 1, /**< CDC DCI interface descriptor ID */
+			INTERFACE_ID_CDC_CCI  = USB_CDC_SERIAL_FIRST_INTERFACE + 0, /**< CDC CCI interface descriptor ID */
+			INTERFACE_ID_CDC_DCI  = USB_CDC_SERIAL_FIRST_INTERFACE + 1, /**< CDC DCI interface descriptor ID */
 #endif
 #ifdef DMBS_MODULE_USB_KEYBOARD
-			INTERFACE_ID_Keyboard = 2, /**< Keyboard interface descriptor ID */
+			INTERFACE_ID_Keyboard = USB_KEYBOARD_FIRST_INTERFACE, /**< Keyboard interface descriptor ID */
+#endif
+#ifdef DMBS_MODULE_USB_RAW_HID
+			INTERFACE_ID_RawHID   = USB_RAW_HID_FIRST_INTERFACE, /**< Raw HID interface descriptor ID */
+#endif
+#ifdef DMBS_MODULE_USB_MIDI
+			INTERFACE_ID_AudioControl = USB_MIDI_FIRST_INTERFACE + 0, /**< MIDI audio control interface descriptor ID */
+			INTERFACE_ID_AudioStream  = USB_MIDI_FIRST_INTERFACE + 1, /**< MIDI audio streaming interface descriptor ID */
 #endif
 		};
 
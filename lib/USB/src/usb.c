@@ -21,6 +21,7 @@ OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
 THE SOFTWARE.
 */
 
+#include <util/atomic.h>
 #include "usb.h"
 
 /** Event handler for the library USB Configuration Changed event. */
@@ -34,7 +35,13 @@ void EVENT_USB_Device_ConfigurationChanged(void)
 	ConfigSuccess &= CDC_Device_ConfigureEndpoints(&VirtualSerial_CDC_Interface);
 #endif
 #ifdef DMBS_MODULE_USB_KEYBOARD
-	ConfigSuccess &= HID_Device_ConfigureEndpoints(&Keyboard_HID_Interface);
+	ConfigSuccess &= usb_keyboard_configure();
+#endif
+#ifdef DMBS_MODULE_USB_RAW_HID
+	ConfigSuccess &= usb_raw_hid_configure();
+#endif
+#ifdef DMBS_MODULE_USB_MIDI
+	ConfigSuccess &= usb_midi_configure();
 #endif
 
 	USB_Device_EnableSOFEvents();
@@ -46,36 +53,121 @@ void EVENT_USB_Device_ControlRequest(void)
 #ifdef DMBS_MODULE_USB_KEYBOARD
     HID_Device_ProcessControlRequest(&Keyboard_HID_Interface);
 #endif
+#ifdef DMBS_MODULE_USB_RAW_HID
+    HID_Device_ProcessControlRequest(&RawHID_HID_Interface);
+#endif
 #ifdef DMBS_MODULE_USB_CDC_SERIAL
 	CDC_Device_ProcessControlRequest(&VirtualSerial_CDC_Interface);
 #endif
 }
 
-/** Event handler for the USB device Start Of Frame event. */
-void EVENT_USB_Device_StartOfFrame(void)
+// Class work of the elapsed frames, in the interrupt or from usb_task()
+static inline void usb_frame_task(uint8_t frames) __attribute__((always_inline));
+static inline void usb_frame_task(uint8_t frames)
 {
     uint8_t PrevSelectedEndpoint = Endpoint_GetCurrentEndpoint();
 
+    // Timers count every frame, the transfers only need to run once
+    while (frames--) {
+#ifdef DMBS_MODULE_USB_KEYBOARD
+        HID_Device_MillisecondElapsed(&Keyboard_HID_Interface);
+#endif
+#ifdef DMBS_MODULE_USB_RAW_HID
+        HID_Device_MillisecondElapsed(&RawHID_HID_Interface);
+#endif
+#ifdef DMBS_MODULE_USB_CDC_SERIAL
+        CDC_Device_MillisecondElapsed();
+#endif
+    }
+
 #ifdef DMBS_MODULE_USB_KEYBOARD
     // Update HID reports if required
-    HID_Device_MillisecondElapsed(&Keyboard_HID_Interface);
     HID_Device_USBTask(&Keyboard_HID_Interface);
 #endif
 
+#ifdef DMBS_MODULE_USB_RAW_HID
+    // Exchange buffered raw HID reports
+    usb_raw_hid_task();
+#endif
+
+#ifdef DMBS_MODULE_USB_MIDI
+    // Pack and unpack buffered MIDI events
+    usb_midi_task();
+#endif
+
 #ifdef DMBS_MODULE_USB_CDC_SERIAL
-    // TODO a general problem:
-    // when you send data via cdc serial, but nobody aknowledges this, it will block for a long time
-    // after that the sketch will continue and the keyboard code etc can continue.
-    // https://github.com/abcminiuser/lufa/issues/106
-    // Flush CDC serial
-    CDC_Device_MillisecondElapsed();
-    CDC_Device_USBTask(&VirtualSerial_CDC_Interface);
+    // Send buffered CDC serial data without blocking
+    usb_cdc_serial_task();
 #endif
 
     Endpoint_SelectEndpoint(PrevSelectedEndpoint);
 }
 
-#ifdef DMBS_MODULE_USB_KEYBOARD
+#if (USB_DEFERRED_TASKS)
+// Frames since the last usb_task() call
+static volatile uint8_t usb_frames_pending = 0;
+#endif
+
+#if (USB_SOF_PROFILE)
+static volatile uint16_t usb_sof_cycles = 0;
+
+uint16_t usb_sof_cycles_max(void)
+{
+    // Return and restart the measurement
+    uint16_t cycles;
+    ATOMIC_BLOCK(ATOMIC_RESTORESTATE) {
+        cycles = usb_sof_cycles;
+        usb_sof_cycles = 0;
+    }
+    return cycles;
+}
+#else
+uint16_t usb_sof_cycles_max(void)
+{
+    return 0;
+}
+#endif
+
+/** Event handler for the USB device Start Of Frame event. */
+void EVENT_USB_Device_StartOfFrame(void)
+{
+#if (USB_SOF_PROFILE)
+    // Only the event is measured, the LUFA interrupt adds a constant overhead
+    uint16_t start = TCNT1;
+#endif
+
+#if (USB_DEFERRED_TASKS)
+    if (usb_frames_pending < USB_TASK_MAX_FRAMES) {
+        usb_frames_pending++;
+    }
+#else
+    usb_frame_task(1);
+#endif
+
+#if (USB_SOF_PROFILE)
+    uint16_t cycles = TCNT1 - start;
+    if (cycles > usb_sof_cycles) {
+        usb_sof_cycles = cycles;
+    }
+#endif
+}
+
+void usb_task(void)
+{
+#if (USB_DEFERRED_TASKS)
+    // 1 byte access is atomic, a frame counted in between is kept for the next call
+    uint8_t frames = usb_frames_pending;
+    if (!frames) {
+        return;
+    }
+    ATOMIC_BLOCK(ATOMIC_RESTORESTATE) {
+        usb_frames_pending -= frames;
+    }
+    usb_frame_task(frames);
+#endif
+}
+
+#if defined(DMBS_MODULE_USB_KEYBOARD) || defined(DMBS_MODULE_USB_RAW_HID)
 /** HID class driver callback function for the creation of HID reports to the host.
  *
  *  \param[in]     HIDInterfaceInfo  Pointer to the HID class interface configuration structure being referenced
@@ -94,11 +186,18 @@ bool CALLBACK_HID_Device_CreateHIDReport(USB_ClassInfo_HID_Device_t* const HIDIn
 {
     // Determine which interface must have its report generated
     if (ReportType == HID_REPORT_ITEM_In){
+#ifdef DMBS_MODULE_USB_KEYBOARD
         if (HIDInterfaceInfo == &Keyboard_HID_Interface)
         {
-            *ReportSize = sizeof(USB_KeyboardReport_Data_t);
-            return CALLBACK_HID_Keyboard_CreateHIDReport((USB_KeyboardReport_Data_t*) ReportData);
+            return CALLBACK_HID_Keyboard_CreateHIDReport((uint8_t*)ReportData, ReportSize);
+        }
+#endif
+#ifdef DMBS_MODULE_USB_RAW_HID
+        if (HIDInterfaceInfo == &RawHID_HID_Interface)
+        {
+            return CALLBACK_HID_RawHID_CreateHIDReport((uint8_t*)ReportData, ReportSize);
         }
+#endif
     }
 	return false;
 }
@@ -119,10 +218,18 @@ void CALLBACK_HID_Device_ProcessHIDReport(USB_ClassInfo_HID_Device_t* const HIDI
 {
     // Determine which interface received an hid report
     if (ReportType == HID_REPORT_ITEM_Out) {
+#ifdef DMBS_MODULE_USB_KEYBOARD
         if (HIDInterfaceInfo == &Keyboard_HID_Interface)
         {
             CALLBACK_HID_Keyboard_ProcessHIDReport((uint8_t*)ReportData);
         }
+#endif
+#ifdef DMBS_MODULE_USB_RAW_HID
+        if (HIDInterfaceInfo == &RawHID_HID_Interface)
+        {
+            CALLBACK_HID_RawHID_ProcessHIDReport((const uint8_t*)ReportData, ReportSize);
+        }
+#endif
     }
 }
-#endif // #ifdef DMBS_MODULE_USB_KEYBOARD
+#endif // #if defined(DMBS_MODULE_USB_KEYBOARD) || defined(DMBS_MODULE_USB_RAW_HID)
@@ -24,6 +24,24 @@ THE SOFTWARE.
 #include "usb_descriptors.h"
 #include "usb.h" // for USB_VERSION
 
+// Check the generated configuration against the endpoint hardware
+_Static_assert(USB_INTERFACE_COUNT > 0,
+    "Unsupported USB device configuration. Please include at least one USB class DMBS module.");
+_Static_assert(USB_ENDPOINT_COUNT <= ENDPOINT_TOTAL_ENDPOINTS,
+    "The enabled USB modules need more endpoints than the MCU has.");
+_Static_assert(USB_FIFO_USED <= USB_FIFO_SIZE,
+    "The enabled USB modules need more endpoint FIFO memory than the MCU has.");
+#ifdef DMBS_MODULE_USB_CDC_SERIAL
+_Static_assert(CDC_TXRX_EPSIZE <= USB_EP_MAX_SIZE(CDC_TX_EPADDR & ENDPOINT_EPNUM_MASK)
+    && CDC_TXRX_EPSIZE <= USB_EP_MAX_SIZE(CDC_RX_EPADDR & ENDPOINT_EPNUM_MASK),
+    "CDC_TXRX_EPSIZE is too big for the assigned endpoints.");
+#endif
+#ifdef DMBS_MODULE_USB_MIDI
+_Static_assert(MIDI_STREAM_EPSIZE <= USB_EP_MAX_SIZE(MIDI_STREAM_IN_EPADDR & ENDPOINT_EPNUM_MASK)
+    && MIDI_STREAM_EPSIZE <= USB_EP_MAX_SIZE(MIDI_STREAM_OUT_EPADDR & ENDPOINT_EPNUM_MASK),
+    "MIDI_STREAM_EPSIZE is too big for the assigned endpoints.");
+#endif
+
 #ifdef DMBS_MODULE_USB_KEYBOARD
 /** HID class report descriptor. This is a special descriptor constructed with values from the
  *  USBIF HID class specification to describe the reports and capabilities of the HID device. This
@@ -33,10 +51,56 @@ THE SOFTWARE.
  */
 const USB_Descriptor_HIDReport_Datatype_t PROGMEM KeyboardReport[] =
 {
+#if defined(USB_KEYBOARD_NKRO) && (USB_KEYBOARD_NKRO)
+	/* N-key rollover report: modifier bits followed by one bit per key.
+	 * The interface still supports the boot protocol, so hosts without
+	 * report protocol (BIOS) receive the standard 6 key report instead.
+	 */
+	HID_RI_USAGE_PAGE(8, 0x01),
+	HID_RI_USAGE(8, 0x06),
+	HID_RI_COLLECTION(8, 0x01),
+	    HID_RI_USAGE_PAGE(8, 0x07),
+	    HID_RI_USAGE_MINIMUM(8, 0xE0),
+	    HID_RI_USAGE_MAXIMUM(8, 0xE7),
+	    HID_RI_LOGICAL_MINIMUM(8, 0x00),
+	    HID_RI_LOGICAL_MAXIMUM(8, 0x01),
+	    HID_RI_REPORT_SIZE(8, 0x01),
+	    HID_RI_REPORT_COUNT(8, 0x08),
+	    HID_RI_INPUT(8, HID_IOF_DATA | HID_IOF_VARIABLE | HID_IOF_ABSOLUTE),
+	    HID_RI_USAGE_PAGE(8, 0x08),
+	    HID_RI_USAGE_MINIMUM(8, 0x01),
+	    HID_RI_USAGE_MAXIMUM(8, 0x05),
+	    HID_RI_REPORT_COUNT(8, 0x05),
+	    HID_RI_REPORT_SIZE(8, 0x01),
+	    HID_RI_OUTPUT(8, HID_IOF_DATA | HID_IOF_VARIABLE | HID_IOF_ABSOLUTE | HID_IOF_NON_VOLATILE),
+	    HID_RI_REPORT_COUNT(8, 0x01),
+	    HID_RI_REPORT_SIZE(8, 0x03),
+	    HID_RI_OUTPUT(8, HID_IOF_CONSTANT),
+	    HID_RI_USAGE_PAGE(8, 0x07),
+	    HID_RI_USAGE_MINIMUM(8, 0x00),
+	    HID_RI_USAGE_MAXIMUM(8, USB_KEYBOARD_NKRO_KEYS - 1),
+	    HID_RI_LOGICAL_MINIMUM(8, 0x00),
+	    HID_RI_LOGICAL_MAXIMUM(8, 0x01),
+	    HID_RI_REPORT_SIZE(8, 0x01),
+	    HID_RI_REPORT_COUNT(8, USB_KEYBOARD_NKRO_KEYS),
+	    HID_RI_INPUT(8, HID_IOF_DATA | HID_IOF_VARIABLE | HID_IOF_ABSOLUTE),
+	HID_RI_END_COLLECTION(0),
+#else
 	/* Use the HID class driver's standard Keyboard report.
 	 *   Max simultaneous keys: 6
 	 */
 	HID_DESCRIPTOR_KEYBOARD(6)
+#endif
+};
+#endif
+
+#ifdef DMBS_MODULE_USB_RAW_HID
+/** Vendor defined report descriptor (usage page 0xFF00) with a single IN and OUT report
+ *  without report ID, so the host can exchange raw 64 byte blocks without a driver.
+ */
+const USB_Descriptor_HIDReport_Datatype_t PROGMEM RawHIDReport[] =
+{
+	HID_DESCRIPTOR_VENDOR(0x00, 0x01, 0x02, 0x03, RAW_HID_EPSIZE)
 };
 #endif
 
@@ -50,23 +114,18 @@ const USB_Descriptor_Device_t PROGMEM DeviceDescriptor =
 	.Header                 = {.Size = sizeof(USB_Descriptor_Device_t), .Type = DTYPE_Device},
 
 	.USBSpecification       = VERSION_BCD(1,1,0),
-#if defined(DMBS_MODULE_USB_CDC_SERIAL) && defined(DMBS_MODULE_USB_KEYBOARD)
-#define USB_INTERFACE_COUNT (2 + 1)
+#if (USB_CDC_SERIAL_IAD)
 	.Class                  = USB_CSCP_IADDeviceClass,
 	.SubClass               = USB_CSCP_IADDeviceSubclass,
 	.Protocol               = USB_CSCP_IADDeviceProtocol,
-#elif defined(DMBS_MODULE_USB_KEYBOARD)
-#define USB_INTERFACE_COUNT 1
-    .Class                  = USB_CSCP_NoDeviceClass,
-    .SubClass               = USB_CSCP_NoDeviceSubclass,
-    .Protocol               = USB_CSCP_NoDeviceProtocol,
 #elif defined(DMBS_MODULE_USB_CDC_SERIAL)
-#define USB_INTERFACE_COUNT 2
     .Class                  = CDC_CSCP_CDCClass,
     .SubClass               = CDC_CSCP_NoSpecificSubclass,
     .Protocol               = CDC_CSCP_NoSpecificProtocol,
 #else
-    #error "Unsupported USB device configuration."
+    .Class                  = USB_CSCP_NoDeviceClass,
+    .SubClass               = USB_CSCP_NoDeviceSubclass,
+    .Protocol               = USB_CSCP_NoDeviceProtocol,
 #endif
 
 	.Endpoint0Size          = FIXED_CONTROL_ENDPOINT_SIZE,
@@ -102,13 +161,13 @@ const USB_Descriptor_Configuration_t PROGMEM ConfigurationDescriptor =
 			.MaxPowerConsumption    = USB_CONFIG_POWER_MA(100)
 		},
 
-#if defined(DMBS_MODULE_USB_CDC_SERIAL) && defined(DMBS_MODULE_USB_KEYBOARD)
+#if (USB_CDC_SERIAL_IAD)
 	.CDC_IAD =
 		{
 			.Header                 = {.Size = sizeof(USB_Descriptor_Interface_Association_t), .Type = DTYPE_InterfaceAssociation},
 
 			.FirstInterfaceIndex    = INTERFACE_ID_CDC_CCI,
-			.TotalInterfaces        = 2,
+			.TotalInterfaces        = USB_CDC_SERIAL_INTERFACES,
 
 			.Class                  = CDC_CSCP_CDCClass,
 			.SubClass               = CDC_CSCP_ACMSubclass,
@@ -242,8 +301,221 @@ const USB_Descriptor_Configuration_t PROGMEM ConfigurationDescriptor =
 			.EndpointAddress        = KEYBOARD_EPADDR,
 			.Attributes             = (EP_TYPE_INTERRUPT | ENDPOINT_ATTR_NO_SYNC | ENDPOINT_USAGE_DATA),
 			.EndpointSize           = KEYBOARD_EPSIZE,
-			.PollingIntervalMS      = 0x05
-		}
+			.PollingIntervalMS      = 0x01
+		},
+#endif
+
+#ifdef DMBS_MODULE_USB_RAW_HID
+	.RawHID_Interface =
+		{
+			.Header                 = {.Size = sizeof(USB_Descriptor_Interface_t), .Type = DTYPE_Interface},
+
+			.InterfaceNumber        = INTERFACE_ID_RawHID,
+			.AlternateSetting       = 0,
+
+			.TotalEndpoints         = 2,
+
+			.Class                  = HID_CSCP_HIDClass,
+			.SubClass               = HID_CSCP_NonBootSubclass,
+			.Protocol               = HID_CSCP_NonBootProtocol,
+
+			.InterfaceStrIndex      = NO_DESCRIPTOR
+		},
+
+	.RawHID_HID =
+		{
+			.Header                 = {.Size = sizeof(USB_HID_Descriptor_HID_t), .Type = HID_DTYPE_HID},
+
+			.HIDSpec                = VERSION_BCD(1,1,1),
+			.CountryCode            = 0x00,
+			.TotalReportDescriptors = 1,
+			.HIDReportType          = HID_DTYPE_Report,
+			.HIDReportLength        = sizeof(RawHIDReport)
+		},
+
+	// Polled every frame for the lowest latency
+	.RawHID_ReportINEndpoint =
+		{
+			.Header                 = {.Size = sizeof(USB_Descriptor_Endpoint_t), .Type = DTYPE_Endpoint},
+
+			.EndpointAddress        = RAW_HID_IN_EPADDR,
+			.Attributes             = (EP_TYPE_INTERRUPT | ENDPOINT_ATTR_NO_SYNC | ENDPOINT_USAGE_DATA),
+			.EndpointSize           = RAW_HID_EPSIZE,
+			.PollingIntervalMS      = 0x01
+		},
+
+	.RawHID_ReportOUTEndpoint =
+		{
+			.Header                 = {.Size = sizeof(USB_Descriptor_Endpoint_t), .Type = DTYPE_Endpoint},
+
+			.EndpointAddress        = RAW_HID_OUT_EPADDR,
+			.Attributes             = (EP_TYPE_INTERRUPT | ENDPOINT_ATTR_NO_SYNC | ENDPOINT_USAGE_DATA),
+			.EndpointSize           = RAW_HID_EPSIZE,
+			.PollingIntervalMS      = 0x01
+		},
+#endif
+
+#ifdef DMBS_MODULE_USB_MIDI
+	.Audio_ControlInterface =
+		{
+			.Header                   = {.Size = sizeof(USB_Descriptor_Interface_t), .Type = DTYPE_Interface},
+
+			.InterfaceNumber          = INTERFACE_ID_AudioControl,
+			.AlternateSetting         = 0,
+
+			.TotalEndpoints           = 0,
+
+			.Class                    = AUDIO_CSCP_AudioClass,
+			.SubClass                 = AUDIO_CSCP_ControlSubclass,
+			.Protocol                 = AUDIO_CSCP_ControlProtocol,
+
+			.InterfaceStrIndex        = NO_DESCRIPTOR
+		},
+
+	.Audio_ControlInterface_SPC =
+		{
+			.Header                   = {.Size = sizeof(USB_Audio_Descriptor_Interface_AC_t), .Type = AUDIO_DTYPE_CSInterface},
+			.Subtype                  = AUDIO_DSUBTYPE_CSInterface_Header,
+
+			.ACSpecification          = VERSION_BCD(1,0,0),
+			.TotalLength              = sizeof(USB_Audio_Descriptor_Interface_AC_t),
+
+			.InCollection             = 1,
+			.InterfaceNumber          = INTERFACE_ID_AudioStream,
+		},
+
+	.Audio_StreamInterface =
+		{
+			.Header                   = {.Size = sizeof(USB_Descriptor_Interface_t), .Type = DTYPE_Interface},
+
+			.InterfaceNumber          = INTERFACE_ID_AudioStream,
+			.AlternateSetting         = 0,
+
+			.TotalEndpoints           = 2,
+
+			.Class                    = AUDIO_CSCP_AudioClass,
+			.SubClass                 = AUDIO_CSCP_MIDIStreamingSubclass,
+			.Protocol                 = AUDIO_CSCP_StreamingProtocol,
+
+			.InterfaceStrIndex        = NO_DESCRIPTOR
+		},
+
+	.Audio_StreamInterface_SPC =
+		{
+			.Header                   = {.Size = sizeof(USB_MIDI_Descriptor_AudioInterface_AS_t), .Type = AUDIO_DTYPE_CSInterface},
+			.Subtype                  = AUDIO_DSUBTYPE_CSInterface_General,
+
+			.AudioSpecification       = VERSION_BCD(1,0,0),
+
+			// Class specific descriptors up to the last endpoint of the streaming interface
+			.TotalLength              = (offsetof(USB_Descriptor_Configuration_t, MIDI_Out_Jack_Endpoint_SPC) +
+			                             sizeof(USB_MIDI_Descriptor_Jack_Endpoint_t) -
+			                             offsetof(USB_Descriptor_Configuration_t, Audio_StreamInterface_SPC))
+		},
+
+	// One cable in each direction: host -> embedded IN jack -> external OUT jack
+	// and external IN jack -> embedded OUT jack -> host.
+	.MIDI_In_Jack_Emb =
+		{
+			.Header                   = {.Size = sizeof(USB_MIDI_Descriptor_InputJack_t), .Type = AUDIO_DTYPE_CSInterface},
+			.Subtype                  = AUDIO_DSUBTYPE_CSInterface_InputTerminal,
+
+			.JackType                 = MIDI_JACKTYPE_Embedded,
+			.JackID                   = 0x01,
+
+			.JackStrIndex             = NO_DESCRIPTOR
+		},
+
+	.MIDI_In_Jack_Ext =
+		{
+			.Header                   = {.Size = sizeof(USB_MIDI_Descriptor_InputJack_t), .Type = AUDIO_DTYPE_CSInterface},
+			.Subtype                  = AUDIO_DSUBTYPE_CSInterface_InputTerminal,
+
+			.JackType                 = MIDI_JACKTYPE_External,
+			.JackID                   = 0x02,
+
+			.JackStrIndex             = NO_DESCRIPTOR
+		},
+
+	.MIDI_Out_Jack_Emb =
+		{
+			.Header                   = {.Size = sizeof(USB_MIDI_Descriptor_OutputJack_t), .Type = AUDIO_DTYPE_CSInterface},
+			.Subtype                  = AUDIO_DSUBTYPE_CSInterface_OutputTerminal,
+
+			.JackType                 = MIDI_JACKTYPE_Embedded,
+			.JackID                   = 0x03,
+
+			.NumberOfPins             = 1,
+			.SourceJackID             = {0x02},
+			.SourcePinID              = {0x01},
+
+			.JackStrIndex             = NO_DESCRIPTOR
+		},
+
+	.MIDI_Out_Jack_Ext =
+		{
+			.Header                   = {.Size = sizeof(USB_MIDI_Descriptor_OutputJack_t), .Type = AUDIO_DTYPE_CSInterface},
+			.Subtype                  = AUDIO_DSUBTYPE_CSInterface_OutputTerminal,
+
+			.JackType                 = MIDI_JACKTYPE_External,
+			.JackID                   = 0x04,
+
+			.NumberOfPins             = 1,
+			.SourceJackID             = {0x01},
+			.SourcePinID              = {0x01},
+
+			.JackStrIndex             = NO_DESCRIPTOR
+		},
+
+	.MIDI_In_Jack_Endpoint =
+		{
+			.Endpoint =
+				{
+					.Header              = {.Size = sizeof(USB_Audio_Descriptor_StreamEndpoint_Std_t), .Type = DTYPE_Endpoint},
+
+					.EndpointAddress     = MIDI_STREAM_OUT_EPADDR,
+					.Attributes          = (EP_TYPE_BULK | ENDPOINT_ATTR_NO_SYNC | ENDPOINT_USAGE_DATA),
+					.EndpointSize        = MIDI_STREAM_EPSIZE,
+					.PollingIntervalMS   = 0x05
+				},
+
+			.Refresh                  = 0,
+			.SyncEndpointNumber       = 0
+		},
+
+	.MIDI_In_Jack_Endpoint_SPC =
+		{
+			.Header                   = {.Size = sizeof(USB_MIDI_Descriptor_Jack_Endpoint_t), .Type = AUDIO_DTYPE_CSEndpoint},
+			.Subtype                  = AUDIO_DSUBTYPE_CSEndpoint_General,
+
+			.TotalEmbeddedJacks       = 0x01,
+			.AssociatedJackID         = {0x01}
+		},
+
+	.MIDI_Out_Jack_Endpoint =
+		{
+			.Endpoint =
+				{
+					.Header              = {.Size = sizeof(USB_Audio_Descriptor_StreamEndpoint_Std_t), .Type = DTYPE_Endpoint},
+
+					.EndpointAddress     = MIDI_STREAM_IN_EPADDR,
+					.Attributes          = (EP_TYPE_BULK | ENDPOINT_ATTR_NO_SYNC | ENDPOINT_USAGE_DATA),
+					.EndpointSize        = MIDI_STREAM_EPSIZE,
+					.PollingIntervalMS   = 0x05
+				},
+
+			.Refresh                  = 0,
+			.SyncEndpointNumber       = 0
+		},
+
+	.MIDI_Out_Jack_Endpoint_SPC =
+		{
+			.Header                   = {.Size = sizeof(USB_MIDI_Descriptor_Jack_Endpoint_t), .Type = AUDIO_DTYPE_CSEndpoint},
+			.Subtype                  = AUDIO_DSUBTYPE_CSEndpoint_General,
+
+			.TotalEmbeddedJacks       = 0x01,
+			.AssociatedJackID         = {0x03}
+		},
 #endif
 };
 
@@ -317,6 +589,12 @@ uint16_t CALLBACK_USB_GetDescriptor(const uint16_t wValue,
 					Address = &ConfigurationDescriptor.HID_KeyboardHID;
 					Size    = sizeof(USB_HID_Descriptor_HID_t);
 					break;
+#endif
+#ifdef DMBS_MODULE_USB_RAW_HID
+				case INTERFACE_ID_RawHID:
+					Address = &ConfigurationDescriptor.RawHID_HID;
+					Size    = sizeof(USB_HID_Descriptor_HID_t);
+					break;
 #endif
 			}
 
@@ -329,6 +607,12 @@ uint16_t CALLBACK_USB_GetDescriptor(const uint16_t wValue,
 					Address = &KeyboardReport;
 					Size    = sizeof(KeyboardReport);
 					break;
+#endif
+#ifdef DMBS_MODULE_USB_RAW_HID
+				case INTERFACE_ID_RawHID:
+					Address = &RawHIDReport;
+					Size    = sizeof(RawHIDReport);
+					break;
 #endif
 			}
 
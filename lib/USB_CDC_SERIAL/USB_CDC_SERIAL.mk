@@ -46,11 +46,19 @@ ifneq ($(filter GCC, $(DMBS_BUILD_MODULES)),)
 $(error Include this module before gcc.mk)
 endif
 
+# Default values of optionally user-supplied variables
+USB_CDC_SERIAL_BUFFER_TX    ?=
+USB_CDC_SERIAL_BUFFER_RX    ?=
+USB_CDC_SERIAL_TX_TIMEOUT   ?=
+USB_CDC_SERIAL_TX_DTR       ?=
+USB_CDC_SERIAL_LEDS         ?=
+
 # Help settings
 DMBS_BUILD_MODULES         += USB_CDC_SERIAL
 DMBS_BUILD_TARGETS         +=
 DMBS_BUILD_MANDATORY_VARS  += DMBS_PATH
-DMBS_BUILD_OPTIONAL_VARS   +=
+DMBS_BUILD_OPTIONAL_VARS   += USB_CDC_SERIAL_BUFFER_TX USB_CDC_SERIAL_BUFFER_RX USB_CDC_SERIAL_TX_TIMEOUT USB_CDC_SERIAL_TX_DTR
+DMBS_BUILD_OPTIONAL_VARS   += USB_CDC_SERIAL_LEDS
 DMBS_BUILD_PROVIDED_VARS   += USB_CDC_SERIAL_SRC
 DMBS_BUILD_PROVIDED_MACROS +=
 
@@ -65,6 +73,22 @@ SRC                += $(USB_CDC_SERIAL_SRC)
 CC_FLAGS           += -DDMBS_MODULE_USB_CDC_SERIAL
 CC_FLAGS           += -I$(USB_CDC_SERIAL_MODULE_PATH)/include
 
+# Optional settings
+ifneq ($(USB_CDC_SERIAL_BUFFER_TX), )
+CC_FLAGS           += -DUSB_CDC_SERIAL_BUFFER_TX=$(USB_CDC_SERIAL_BUFFER_TX)
+endif
+ifneq ($(USB_CDC_SERIAL_BUFFER_RX), )
+CC_FLAGS           += -DUSB_CDC_SERIAL_BUFFER_RX=$(USB_CDC_SERIAL_BUFFER_RX)
+endif
+ifneq ($(USB_CDC_SERIAL_TX_TIMEOUT), )
+CC_FLAGS           += -DUSB_CDC_SERIAL_TX_TIMEOUT=$(USB_CDC_SERIAL_TX_TIMEOUT)
+endif
+ifneq ($(USB_CDC_SERIAL_TX_DTR), )
+CC_FLAGS           += -DUSB_CDC_SERIAL_TX_DTR=$(USB_CDC_SERIAL_TX_DTR)
+endif
+ifneq ($(USB_CDC_SERIAL_LEDS), )
+CC_FLAGS           += -DUSB_CDC_SERIAL_LEDS=$(USB_CDC_SERIAL_LEDS)
+endif
 
 # Phony build targets for this module
 .PHONY: $(DMBS_BUILD_TARGETS)
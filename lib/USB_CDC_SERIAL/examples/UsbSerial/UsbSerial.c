@@ -27,6 +27,7 @@ THE SOFTWARE.
 #include <stdio.h>
 #include "board_leds.h"
 #include "usart.h"
+#include "usb.h"
 #include "usb_cdc_serial.h"
 
 // Filestreams for stdio functions
@@ -56,6 +57,9 @@ int main(void)
 
     while(true)
     {
+        // Move USB data if USB_DEFERRED_TASKS is set
+        usb_task();
+
         // Usb -> Serial
 		int c = fgetc(&USBSerialStream);
         if(c >= 0){
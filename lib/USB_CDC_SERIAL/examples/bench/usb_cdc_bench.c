@@ -0,0 +1,261 @@
+/*
+Copyright (c) 2018 NicoHood
+See the readme for credit to other people.
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+THE SOFTWARE.
+*/
+
+// USB CDC throughput, latency and CPU load benchmark.
+// USB can't be simulated, so this runs on real hardware and is controlled by
+// the host tool in ../../host (usb_cdc_bench -d /dev/ttyACM0).
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stdio.h>
+#include <avr/io.h>
+#include <avr/interrupt.h>
+#include "usb.h"
+#include "usb_cdc_serial.h"
+#include "usb_cdc_bench.h"
+
+// Filestream for the per byte stdio path
+static FILE USBSerialStream;
+
+// Test pattern, with an extra packet to send 64 bytes from any offset
+static uint8_t pattern[256 + CDC_TXRX_EPSIZE];
+
+// Timer1 runs without prescaler as cycle counter. Every loop iteration is far
+// below its 4ms overflow, so the 16 bit differences add up to exact totals.
+// An iteration counts as busy if it moved data. Interrupts are counted in the
+// iteration they interrupt, so the load is exact over a whole transfer only.
+static uint32_t cycles_total;
+static uint32_t cycles_busy;
+static uint16_t cycles_last;
+
+static void load_start(void)
+{
+    cycles_total = 0;
+    cycles_busy = 0;
+    cycles_last = TCNT1;
+}
+
+static void load_account(bool busy)
+{
+    uint16_t now = TCNT1;
+    uint16_t cycles = now - cycles_last;
+    cycles_last = now;
+    cycles_total += cycles;
+    if (busy) {
+        cycles_busy += cycles;
+    }
+}
+
+static void write_all(const uint8_t* buff, size_t len)
+{
+    while (len && usb_cdc_serial_connected()) {
+        usb_task();
+        size_t count = usb_cdc_serial_write(buff, len);
+        buff += count;
+        len -= count;
+    }
+}
+
+static bool put_all(uint8_t c)
+{
+    while (usb_cdc_serial_connected()) {
+        usb_task();
+        if (fputc(c, &USBSerialStream) != EOF) {
+            return true;
+        }
+    }
+    return false;
+}
+
+// Checks received data against the pattern, returns the number of errors
+static uint8_t check(const uint8_t* buff, uint8_t len, uint32_t pos)
+{
+    uint8_t errors = 0;
+    const uint8_t* expected = &pattern[(uint8_t)pos];
+    for (uint8_t i = 0; i < len; i++) {
+        if (buff[i] != expected[i]) {
+            errors++;
+        }
+    }
+    return errors;
+}
+
+// One step of a transfer with the selected path, returns the number of bytes moved
+static uint8_t step(uint8_t path, uint8_t cmd, uint32_t pos, uint32_t count, uint32_t* errors)
+{
+    uint8_t buff[CDC_TXRX_EPSIZE];
+    uint8_t len = (count - pos > CDC_TXRX_EPSIZE) ? CDC_TXRX_EPSIZE : (count - pos);
+
+    // Per byte like most Arduino sketches
+    if (path == USB_CDC_BENCH_PATH_STDIO)
+    {
+        if (cmd == USB_CDC_BENCH_CMD_IN) {
+            return fputc(pattern[(uint8_t)pos], &USBSerialStream) != EOF;
+        }
+        int c = fgetc(&USBSerialStream);
+        if (c < 0) {
+            return 0;
+        }
+        if (cmd == USB_CDC_BENCH_CMD_ECHO) {
+            put_all(c);
+        }
+        else if ((uint8_t)c != pattern[(uint8_t)pos]) {
+            (*errors)++;
+        }
+        return 1;
+    }
+
+    // Sending can't borrow, both paths write whole packets
+    if (cmd == USB_CDC_BENCH_CMD_IN) {
+        return usb_cdc_serial_write(&pattern[(uint8_t)pos], len);
+    }
+
+    // Bulk copy
+    if (path == USB_CDC_BENCH_PATH_BULK)
+    {
+        len = usb_cdc_serial_read(buff, len);
+        if (cmd == USB_CDC_BENCH_CMD_ECHO) {
+            write_all(buff, len);
+        }
+        else {
+            *errors += check(buff, len, pos);
+        }
+        return len;
+    }
+
+    // Zero copy
+    const uint8_t* data;
+    uint8_t avail = usb_cdc_serial_read_borrow(&data);
+    if (len > avail) {
+        len = avail;
+    }
+    if (cmd == USB_CDC_BENCH_CMD_ECHO) {
+        write_all(data, len);
+    }
+    else {
+        *errors += check(data, len, pos);
+    }
+    usb_cdc_serial_read_release(len);
+    return len;
+}
+
+static void run(uint8_t path, uint8_t cmd, uint32_t count)
+{
+    uint32_t pos = 0;
+    uint32_t errors = 0;
+    load_start();
+    usb_sof_cycles_max();
+    while ((pos < count) && usb_cdc_serial_connected()) {
+        usb_task();
+        uint8_t moved = step(path, cmd, pos, count, &errors);
+        pos += moved;
+        load_account(moved);
+    }
+
+    // Report in 0.1% steps
+    uint32_t permille = cycles_total / 1000;
+    char line[USB_CDC_BENCH_REPORT_LINE];
+    int len = snprintf(line, sizeof(line), USB_CDC_BENCH_REPORT, path, cmd,
+        (unsigned long)pos, (unsigned long)errors,
+        (unsigned long)(cycles_total / (F_CPU / 1000)),
+        (unsigned int)(permille ? (cycles_busy / permille) : 0),
+        (unsigned int)usb_sof_cycles_max());
+    write_all((const uint8_t*)line, len);
+}
+
+int main(void)
+{
+    // Initialize libraries
+    USB_Init();
+    usb_cdc_serial_init_stream(&USBSerialStream);
+
+    for (uint16_t i = 0; i < sizeof(pattern); i++) {
+        pattern[i] = USB_CDC_BENCH_PATTERN(i);
+    }
+
+    // Free running cycle counter
+    TCCR1A = 0;
+    TCCR1B = (1 << CS10);
+
+    // Enable interrupts
+    sei();
+
+    uint8_t path = USB_CDC_BENCH_PATH_BULK;
+    uint8_t cmd[USB_CDC_BENCH_CMD_SIZE];
+    uint8_t received = 0;
+    while (true)
+    {
+        usb_task();
+
+        // Forget partial commands of a closed port
+        if (!usb_cdc_serial_connected()) {
+            received = 0;
+            continue;
+        }
+        received += usb_cdc_serial_read(&cmd[received], sizeof(cmd) - received);
+        if (received < sizeof(cmd)) {
+            continue;
+        }
+        received = 0;
+
+        uint32_t arg = cmd[1] | ((uint32_t)cmd[2] << 8) | ((uint32_t)cmd[3] << 16) | ((uint32_t)cmd[4] << 24);
+        switch (cmd[0])
+        {
+            case USB_CDC_BENCH_CMD_PATH:
+                path = arg;
+#if !(USB_CDC_SERIAL_BUFFER_RX)
+                // Borrowing requires the RX buffer
+                if (path == USB_CDC_BENCH_PATH_BORROW) {
+                    path = USB_CDC_BENCH_PATH_BULK;
+                }
+#endif
+                run(path, cmd[0], 0);
+                break;
+            case USB_CDC_BENCH_CMD_IN:
+            case USB_CDC_BENCH_CMD_OUT:
+            case USB_CDC_BENCH_CMD_ECHO:
+                run(path, cmd[0], arg);
+                break;
+            default:
+                // Ignore unknown commands
+                break;
+        }
+    }
+}
+
+/** Event handler for the CDC Class driver Line Encoding Changed event.
+ *
+ *  \param[in] CDCInterfaceInfo  Pointer to the CDC class interface configuration structure being referenced
+ */
+void EVENT_CDC_Device_LineEncodingChanged(USB_ClassInfo_CDC_Device_t* const CDCInterfaceInfo)
+{
+}
+
+/** CDC class driver callback function the processing of changes to the virtual
+ *  control lines sent from the host..
+ *
+ *  \param[in] CDCInterfaceInfo  Pointer to the CDC class interface configuration structure being referenced
+ */
+void EVENT_CDC_Device_ControLineStateChanged(USB_ClassInfo_CDC_Device_t *const CDCInterfaceInfo)
+{
+}
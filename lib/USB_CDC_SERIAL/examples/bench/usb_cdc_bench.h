@@ -0,0 +1,60 @@
+/*
+Copyright (c) 2018 NicoHood
+See the readme for credit to other people.
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+THE SOFTWARE.
+*/
+
+// Protocol between the USB CDC benchmark firmware and its host tool.
+// Shared by both sides, so it must stay plain C without AVR headers.
+
+// Include guard
+#pragma once
+
+// Commands are a single byte followed by a 32 bit little endian argument.
+// The device answers every command with a report line after it is done.
+#define USB_CDC_BENCH_CMD_SIZE  5
+
+// Device sends <count> bytes of the test pattern (IN throughput)
+#define USB_CDC_BENCH_CMD_IN    'I'
+
+// Device receives and checks <count> bytes of the test pattern (OUT throughput)
+#define USB_CDC_BENCH_CMD_OUT   'O'
+
+// Device echoes the next <count> bytes (round trip latency)
+#define USB_CDC_BENCH_CMD_ECHO  'E'
+
+// Selects the library functions used for the following commands, <count> is the path
+#define USB_CDC_BENCH_CMD_PATH  'P'
+
+// Per byte stdio (fgetc/fputc), bulk read/write and zero copy borrow/release
+#define USB_CDC_BENCH_PATH_STDIO    's'
+#define USB_CDC_BENCH_PATH_BULK     'b'
+#define USB_CDC_BENCH_PATH_BORROW   'z'
+
+// Test pattern byte at a position of the transfer.
+// It repeats every 256 bytes, so the device can send it from a table.
+#define USB_CDC_BENCH_PATTERN(i) ((uint8_t)((i) * 7))
+
+// Report line of the device, one per command:
+// path, command, transferred bytes, pattern errors, duration in ms
+// CPU load in 0.1% (cycles spent moving data / all cycles)
+// and the longest start of frame interrupt in cycles (0 if not measured).
+#define USB_CDC_BENCH_REPORT "#path=%c cmd=%c bytes=%lu err=%lu ms=%lu load=%u sof=%u\n"
+#define USB_CDC_BENCH_REPORT_LINE 80
@@ -0,0 +1,492 @@
+/*
+Copyright (c) 2018 NicoHood
+See the readme for credit to other people.
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+THE SOFTWARE.
+*/
+
+// Host side of the USB CDC benchmark (examples/bench).
+// Measures IN/OUT throughput and the round trip latency of 1, 8 and 64 byte
+// messages for every read/write path of the firmware and prints the device
+// reports (duration and CPU load) next to the host measurements.
+//
+// Usage: usb_cdc_bench -d /dev/ttyACM0 [-p paths] [-n bytes] [-r repetitions]
+//        usb_cdc_bench -l [-p paths] [-n bytes] [-r repetitions]
+// -p selects the paths to compare: s (stdio), b (bulk) and z (borrow), default "sbz".
+// -l runs against a local stand-in device on a pty instead of hardware,
+//    which tests the protocol and reporting without a device (make check).
+//    Its numbers only describe the pty, not the USB CDC library.
+// Returns 1 if any data or report was wrong or missing.
+
+#define _DEFAULT_SOURCE
+#define _XOPEN_SOURCE 600
+#include <stdint.h>
+#include <stdbool.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <poll.h>
+#include <signal.h>
+#include <termios.h>
+#include <time.h>
+#include <unistd.h>
+#include <sys/wait.h>
+#include "../examples/bench/usb_cdc_bench.h"
+
+// Give up if the device does not answer for this time
+#define TIMEOUT_MS 3000
+
+// Chunk size of the bulk paths, same as the USB packet size
+#define CHUNK 64
+
+typedef struct {
+    char path;
+    char cmd;
+    unsigned long bytes;
+    unsigned long errors;
+    unsigned long ms;
+    unsigned int load;
+    unsigned int sof;
+} report_t;
+
+static double now_ms(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec * 1e3 + ts.tv_nsec / 1e6;
+}
+
+static int write_all(int fd, const uint8_t* buff, size_t len)
+{
+    while (len) {
+        ssize_t ret = write(fd, buff, len);
+        if (ret < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+            return -1;
+        }
+        buff += ret;
+        len -= ret;
+    }
+    return 0;
+}
+
+// Reads exactly len bytes, a negative timeout waits forever
+static int read_all(int fd, uint8_t* buff, size_t len, int timeout)
+{
+    while (len) {
+        struct pollfd pfd = { fd, POLLIN, 0 };
+        int ret = poll(&pfd, 1, timeout);
+        if (ret < 0 && errno == EINTR) {
+            continue;
+        }
+        if (ret <= 0) {
+            return -1;
+        }
+        ssize_t count = read(fd, buff, len);
+        if (count <= 0) {
+            return -1;
+        }
+        buff += count;
+        len -= count;
+    }
+    return 0;
+}
+
+static void fill_pattern(uint8_t* buff, size_t len, unsigned long pos)
+{
+    for (size_t i = 0; i < len; i++) {
+        buff[i] = USB_CDC_BENCH_PATTERN(pos + i);
+    }
+}
+
+static unsigned long check_pattern(const uint8_t* buff, size_t len, unsigned long pos)
+{
+    unsigned long errors = 0;
+    for (size_t i = 0; i < len; i++) {
+        if (buff[i] != USB_CDC_BENCH_PATTERN(pos + i)) {
+            errors++;
+        }
+    }
+    return errors;
+}
+
+static int send_command(int fd, char cmd, uint32_t arg)
+{
+    uint8_t buff[USB_CDC_BENCH_CMD_SIZE] = {
+        (uint8_t)cmd, (uint8_t)arg, (uint8_t)(arg >> 8), (uint8_t)(arg >> 16), (uint8_t)(arg >> 24)
+    };
+    return write_all(fd, buff, sizeof(buff));
+}
+
+// Reads and parses the report line which ends every command
+static int read_report(int fd, report_t* report)
+{
+    char line[USB_CDC_BENCH_REPORT_LINE];
+    size_t len = 0;
+    while (true) {
+        uint8_t c;
+        if (read_all(fd, &c, 1, TIMEOUT_MS) < 0) {
+            fprintf(stderr, "No report from the device\n");
+            return -1;
+        }
+        if (!len && c != '#') {
+            fprintf(stderr, "Unexpected data 0x%02X instead of a report\n", c);
+            return -1;
+        }
+        if (len < sizeof(line) - 1) {
+            line[len++] = c;
+        }
+        if (c == '\n') {
+            break;
+        }
+    }
+    line[len] = '\0';
+
+    if (sscanf(line, "#path=%c cmd=%c bytes=%lu err=%lu ms=%lu load=%u sof=%u",
+               &report->path, &report->cmd, &report->bytes, &report->errors,
+               &report->ms, &report->load, &report->sof) != 7) {
+        fprintf(stderr, "Invalid report: %s", line);
+        return -1;
+    }
+    return 0;
+}
+
+static int check_report(const report_t* report, char path, char cmd, unsigned long bytes)
+{
+    if (report->path != path || report->cmd != cmd || report->bytes != bytes) {
+        fprintf(stderr, "Report mismatch: path=%c cmd=%c bytes=%lu, expected path=%c cmd=%c bytes=%lu\n",
+                report->path, report->cmd, report->bytes, path, cmd, bytes);
+        return -1;
+    }
+    return 0;
+}
+
+static void print_throughput(const char* name, const report_t* report, unsigned long bytes,
+                             unsigned long errors, double ms)
+{
+    printf("%c  %-4s %8lu bytes %8.1f KB/s  device %6lu ms  load %5.1f%%  sof %5u cycles  errors %lu\n",
+           report->path, name, bytes, ms > 0 ? bytes / ms : 0.0, report->ms,
+           report->load / 10.0, report->sof, errors + report->errors);
+}
+
+static int compare_double(const void* a, const void* b)
+{
+    double x = *(const double*)a;
+    double y = *(const double*)b;
+    return (x > y) - (x < y);
+}
+
+// Device sends the pattern as fast as possible
+static int bench_in(int fd, char path, unsigned long bytes)
+{
+    uint8_t buff[4096];
+    unsigned long errors = 0;
+    double start = now_ms();
+    if (send_command(fd, USB_CDC_BENCH_CMD_IN, bytes) < 0) {
+        return -1;
+    }
+    for (unsigned long pos = 0; pos < bytes;) {
+        size_t len = (bytes - pos > sizeof(buff)) ? sizeof(buff) : (bytes - pos);
+        if (read_all(fd, buff, len, TIMEOUT_MS) < 0) {
+            fprintf(stderr, "IN transfer stopped after %lu bytes\n", pos);
+            return -1;
+        }
+        errors += check_pattern(buff, len, pos);
+        pos += len;
+    }
+    double ms = now_ms() - start;
+
+    report_t report;
+    if (read_report(fd, &report) < 0 || check_report(&report, path, USB_CDC_BENCH_CMD_IN, bytes) < 0) {
+        return -1;
+    }
+    print_throughput("in", &report, bytes, errors, ms);
+    return errors ? -1 : 0;
+}
+
+// Device receives and checks the pattern
+static int bench_out(int fd, char path, unsigned long bytes)
+{
+    uint8_t buff[4096];
+    double start = now_ms();
+    if (send_command(fd, USB_CDC_BENCH_CMD_OUT, bytes) < 0) {
+        return -1;
+    }
+    for (unsigned long pos = 0; pos < bytes;) {
+        size_t len = (bytes - pos > sizeof(buff)) ? sizeof(buff) : (bytes - pos);
+        fill_pattern(buff, len, pos);
+        if (write_all(fd, buff, len) < 0) {
+            fprintf(stderr, "Write failed: %s\n", strerror(errno));
+            return -1;
+        }
+        pos += len;
+    }
+
+    // The device reports after it received the last byte
+    report_t report;
+    if (read_report(fd, &report) < 0 || check_report(&report, path, USB_CDC_BENCH_CMD_OUT, bytes) < 0) {
+        return -1;
+    }
+    double ms = now_ms() - start;
+    print_throughput("out", &report, bytes, 0, ms);
+    return report.errors ? -1 : 0;
+}
+
+// Ping pong of messages through the device
+static int bench_echo(int fd, char path, size_t size, unsigned long repetitions)
+{
+    double* times = (double*)malloc(repetitions * sizeof(double));
+    if (!times || send_command(fd, USB_CDC_BENCH_CMD_ECHO, size * repetitions) < 0) {
+        free(times);
+        return -1;
+    }
+
+    int ret = 0;
+    unsigned long errors = 0;
+    for (unsigned long i = 0; i < repetitions; i++) {
+        uint8_t out[CHUNK];
+        uint8_t in[CHUNK];
+        fill_pattern(out, size, i);
+        double start = now_ms();
+        if (write_all(fd, out, size) < 0 || read_all(fd, in, size, TIMEOUT_MS) < 0) {
+            fprintf(stderr, "Echo stopped after %lu messages\n", i);
+            free(times);
+            return -1;
+        }
+        times[i] = now_ms() - start;
+        errors += check_pattern(in, size, i);
+    }
+
+    report_t report;
+    if (read_report(fd, &report) < 0
+        || check_report(&report, path, USB_CDC_BENCH_CMD_ECHO, size * repetitions) < 0) {
+        ret = -1;
+    }
+    else {
+        qsort(times, repetitions, sizeof(double), compare_double);
+        double sum = 0;
+        for (unsigned long i = 0; i < repetitions; i++) {
+            sum += times[i];
+        }
+        printf("%c  echo %8zu bytes  min %6.3f avg %6.3f p99 %6.3f max %6.3f ms  load %5.1f%%  sof %5u cycles  errors %lu\n",
+               path, size, times[0], sum / repetitions, times[(repetitions * 99) / 100],
+               times[repetitions - 1], report.load / 10.0, report.sof, errors);
+        ret = errors ? -1 : 0;
+    }
+    free(times);
+    return ret;
+}
+
+static int bench_path(int fd, char path, unsigned long bytes, unsigned long repetitions)
+{
+    // The device acknowledges the selected path. Firmware without RX buffer
+    // can't borrow and uses the bulk path instead.
+    report_t report;
+    if (send_command(fd, USB_CDC_BENCH_CMD_PATH, (uint8_t)path) < 0 || read_report(fd, &report) < 0) {
+        return -1;
+    }
+    if (report.path != path) {
+        printf("%c  not supported by the device, using %c\n", path, report.path);
+        path = report.path;
+    }
+
+    static const size_t sizes[] = { 1, 8, 64 };
+    int ret = 0;
+    ret |= bench_in(fd, path, bytes);
+    ret |= bench_out(fd, path, bytes);
+    for (size_t i = 0; i < sizeof(sizes) / sizeof(sizes[0]); i++) {
+        ret |= bench_echo(fd, path, sizes[i], repetitions);
+    }
+    return ret;
+}
+
+// Local stand-in of the firmware, serving the same protocol on a pty.
+// The load is the CPU time of this process compared to the elapsed time.
+static void stand_in(int fd)
+{
+    char path = USB_CDC_BENCH_PATH_BULK;
+    while (true) {
+        uint8_t cmd[USB_CDC_BENCH_CMD_SIZE];
+        if (read_all(fd, cmd, sizeof(cmd), -1) < 0) {
+            return;
+        }
+        uint32_t arg = cmd[1] | ((uint32_t)cmd[2] << 8) | ((uint32_t)cmd[3] << 16) | ((uint32_t)cmd[4] << 24);
+        if (cmd[0] == USB_CDC_BENCH_CMD_PATH) {
+            path = (char)arg;
+            arg = 0;
+        }
+
+        // Per byte system calls for the stdio path, packets otherwise
+        size_t chunk = (path == USB_CDC_BENCH_PATH_STDIO) ? 1 : CHUNK;
+        struct timespec cpu_start, cpu_end;
+        clock_gettime(CLOCK_PROCESS_CPUTIME_ID, &cpu_start);
+        double start = now_ms();
+        unsigned long errors = 0;
+        for (unsigned long pos = 0; pos < arg;) {
+            uint8_t buff[CHUNK];
+            size_t len = (arg - pos > chunk) ? chunk : (arg - pos);
+            if (cmd[0] == USB_CDC_BENCH_CMD_IN) {
+                fill_pattern(buff, len, pos);
+                if (write_all(fd, buff, len) < 0) {
+                    return;
+                }
+            }
+            else {
+                ssize_t count = read(fd, buff, len);
+                if (count <= 0) {
+                    return;
+                }
+                len = count;
+                if (cmd[0] == USB_CDC_BENCH_CMD_ECHO) {
+                    if (write_all(fd, buff, len) < 0) {
+                        return;
+                    }
+                }
+                else if (cmd[0] == USB_CDC_BENCH_CMD_OUT) {
+                    errors += check_pattern(buff, len, pos);
+                }
+            }
+            pos += len;
+        }
+        clock_gettime(CLOCK_PROCESS_CPUTIME_ID, &cpu_end);
+        double ms = now_ms() - start;
+        double cpu = (cpu_end.tv_sec - cpu_start.tv_sec) * 1e3 + (cpu_end.tv_nsec - cpu_start.tv_nsec) / 1e6;
+
+        char line[USB_CDC_BENCH_REPORT_LINE];
+        int len = snprintf(line, sizeof(line), USB_CDC_BENCH_REPORT, path, cmd[0],
+                           (unsigned long)arg, errors, (unsigned long)ms,
+                           (unsigned int)(ms > 0 ? (cpu > ms ? 1000 : cpu * 1000 / ms) : 0), 0u);
+        if (write_all(fd, (const uint8_t*)line, len) < 0) {
+            return;
+        }
+    }
+}
+
+static int open_stand_in(pid_t* child)
+{
+    int master = posix_openpt(O_RDWR | O_NOCTTY);
+    if (master < 0 || grantpt(master) < 0 || unlockpt(master) < 0) {
+        fprintf(stderr, "Can't create pty: %s\n", strerror(errno));
+        return -1;
+    }
+    int slave = open(ptsname(master), O_RDWR | O_NOCTTY);
+    if (slave < 0) {
+        fprintf(stderr, "Can't open pty: %s\n", strerror(errno));
+        return -1;
+    }
+
+    // Raw binary data in both directions, without echo
+    struct termios tty;
+    if (tcgetattr(slave, &tty) == 0) {
+        cfmakeraw(&tty);
+        tcsetattr(slave, TCSANOW, &tty);
+    }
+
+    *child = fork();
+    if (*child < 0) {
+        fprintf(stderr, "Can't start the stand-in: %s\n", strerror(errno));
+        return -1;
+    }
+    if (!*child) {
+        close(master);
+        stand_in(slave);
+        _exit(0);
+    }
+    close(slave);
+    return master;
+}
+
+static int open_serial(const char* device)
+{
+    int fd = open(device, O_RDWR | O_NOCTTY);
+    if (fd < 0) {
+        fprintf(stderr, "Can't open %s: %s\n", device, strerror(errno));
+        return -1;
+    }
+
+    // Raw mode, the baud rate is ignored by USB CDC devices.
+    // Opening the port sets DTR, which the device waits for.
+    struct termios tty;
+    if (tcgetattr(fd, &tty) == 0) {
+        cfmakeraw(&tty);
+        cfsetispeed(&tty, B115200);
+        cfsetospeed(&tty, B115200);
+        tcsetattr(fd, TCSANOW, &tty);
+    }
+    tcflush(fd, TCIOFLUSH);
+    return fd;
+}
+
+int main(int argc, char** argv)
+{
+    const char* device = NULL;
+    const char* paths = "sbz";
+    unsigned long bytes = 65536;
+    unsigned long repetitions = 200;
+    bool local = false;
+
+    int opt;
+    while ((opt = getopt(argc, argv, "d:p:n:r:l")) != -1) {
+        switch (opt) {
+        case 'd': device = optarg; break;
+        case 'p': paths = optarg; break;
+        case 'n': bytes = strtoul(optarg, NULL, 0); break;
+        case 'r': repetitions = strtoul(optarg, NULL, 0); break;
+        case 'l': local = true; break;
+        default:
+            fprintf(stderr, "Usage: %s -d device | -l [-p paths] [-n bytes] [-r repetitions]\n", argv[0]);
+            return 1;
+        }
+    }
+    if ((!device == !local) || !bytes || bytes > UINT32_MAX || !repetitions || repetitions * CHUNK > UINT32_MAX) {
+        fprintf(stderr, "Invalid arguments, see %s -h\n", argv[0]);
+        return 1;
+    }
+    for (const char* p = paths; *p; p++) {
+        if (*p != USB_CDC_BENCH_PATH_STDIO && *p != USB_CDC_BENCH_PATH_BULK && *p != USB_CDC_BENCH_PATH_BORROW) {
+            fprintf(stderr, "Unknown path %c\n", *p);
+            return 1;
+        }
+    }
+
+    pid_t child = 0;
+    int fd = local ? open_stand_in(&child) : open_serial(device);
+    if (fd < 0) {
+        return 1;
+    }
+    if (local) {
+        printf("Local pty stand-in, the numbers do not describe the device\n");
+    }
+
+    int ret = 0;
+    for (const char* p = paths; *p; p++) {
+        ret |= bench_path(fd, *p, bytes, repetitions);
+    }
+
+    close(fd);
+    if (child > 0) {
+        kill(child, SIGTERM);
+        waitpid(child, NULL, 0);
+    }
+    return ret ? 1 : 0;
+}
@@ -30,12 +30,66 @@ extern "C" {
 // Software version
 #define USB_CDC_SERIAL_VERSION 100
 
+#include <stdint.h>
+#include <stddef.h>
+#include <stdbool.h>
+#include <stdio.h>
 #include <LUFA/Drivers/USB/Class/CDCClass.h>
 
+// Default TX buffer size. Buffered data is sent in 64 byte packets on every
+// USB start of frame (1ms), writing only waits up to USB_CDC_SERIAL_TX_TIMEOUT.
+// 0 sends data synchronously with LUFA, which may block up to 100ms.
+#ifndef USB_CDC_SERIAL_BUFFER_TX
+#define USB_CDC_SERIAL_BUFFER_TX 64
+#endif
+
+// Default RX buffer size. 0 (default) reads directly from the endpoint banks,
+// which is fastest for bulk reads but cannot borrow data. A buffer is filled
+// on every USB start of frame (1ms), which limits the throughput to the buffer
+// size per ms and copies every byte twice, but enables zero copy borrowing.
+#ifndef USB_CDC_SERIAL_BUFFER_RX
+#define USB_CDC_SERIAL_BUFFER_RX 0
+#endif
+
+// Time in ms to wait for free TX buffer space while the host is connected,
+// like the blocking LUFA stream timeout. Data which does not fit into the
+// buffer afterwards is dropped and further writes do not wait until the host
+// reads again. 0 never blocks and drops data as soon as the buffer is full.
+#ifndef USB_CDC_SERIAL_TX_TIMEOUT
+#define USB_CDC_SERIAL_TX_TIMEOUT 100
+#endif
+
+// Only send data if the host opened the port and set DTR, otherwise drop it.
+// Many terminal programs do not set DTR, so this is disabled by default.
+#ifndef USB_CDC_SERIAL_TX_DTR
+#define USB_CDC_SERIAL_TX_DTR 0
+#endif
+
+// Flash the RX/TX leds of the board on USB activity.
+// The leds are updated once per USB frame, 0 removes all led code.
+#ifndef USB_CDC_SERIAL_LEDS
+#define USB_CDC_SERIAL_LEDS 1
+#endif
+
 void EVENT_CDC_Device_LineEncodingChanged(USB_ClassInfo_CDC_Device_t* const CDCInterfaceInfo);
 void EVENT_CDC_Device_ControLineStateChanged(USB_ClassInfo_CDC_Device_t *const CDCInterfaceInfo);
 
 void usb_cdc_serial_init_stream(FILE* const stream);
+bool usb_cdc_serial_connected(void);
+
+// Transmit, returns the number of bytes sent or buffered
+size_t usb_cdc_serial_write(const uint8_t* buff, size_t len);
+uint8_t usb_cdc_serial_avail_write(void);
+uint16_t usb_cdc_serial_dropped(void);
+
+// Receive
+uint8_t usb_cdc_serial_avail_read(void);
+size_t usb_cdc_serial_read(uint8_t* buff, size_t len);
+
+// Zero copy receive. Returns the number of contiguous bytes at *data, which
+// stay valid until they are released. May be less than usb_cdc_serial_avail_read().
+uint8_t usb_cdc_serial_read_borrow(const uint8_t** data);
+void usb_cdc_serial_read_release(uint8_t len);
 
 #ifdef __cplusplus
 }
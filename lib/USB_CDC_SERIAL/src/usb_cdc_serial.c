@@ -21,9 +21,18 @@ OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
 THE SOFTWARE.
 */
 
-#include "usb_descriptors.h"
+#include "usb.h"
+#include "usb_cdc_serial.h"
 #include "board_leds.h"
 
+// Check buffer size limits
+_Static_assert(USB_CDC_SERIAL_BUFFER_TX < (1 << 8) && USB_CDC_SERIAL_BUFFER_TX >= 0,
+    "USB_CDC_SERIAL_BUFFER_TX is an unsigned 8bit value. Please choose 8, 16, 32, 64, 128 or 255");
+_Static_assert(USB_CDC_SERIAL_BUFFER_RX < (1 << 8) && USB_CDC_SERIAL_BUFFER_RX >= 0,
+    "USB_CDC_SERIAL_BUFFER_RX is an unsigned 8bit value. Please choose 8, 16, 32, 64, 128 or 255");
+_Static_assert(USB_CDC_SERIAL_TX_TIMEOUT < (1 << 11),
+    "USB_CDC_SERIAL_TX_TIMEOUT is limited by the 11 bit USB frame number");
+
 /** LUFA CDC Class driver interface configuration and state information. This structure is
  *  passed to all CDC Class driver functions, so that multiple instances of the same class
  *  within a device can be differentiated from one another.
@@ -37,13 +46,13 @@ USB_ClassInfo_CDC_Device_t VirtualSerial_CDC_Interface =
 					{
 						.Address                = CDC_TX_EPADDR,
 						.Size                   = CDC_TXRX_EPSIZE,
-						.Banks                  = 2,
+						.Banks                  = CDC_TXRX_BANKS,
 					},
 				.DataOUTEndpoint                =
 					{
 						.Address                = CDC_RX_EPADDR,
 						.Size                   = CDC_TXRX_EPSIZE,
-						.Banks                  = 2,
+						.Banks                  = CDC_TXRX_BANKS,
 					},
 				.NotificationEndpoint           =
 					{
@@ -54,12 +63,23 @@ USB_ClassInfo_CDC_Device_t VirtualSerial_CDC_Interface =
 			},
 	};
 
+#if (USB_CDC_SERIAL_LEDS)
+// The data paths only flag activity, the leds are updated once per frame
 #define TX_RX_LED_PULSE_MS 3
 static uint8_t rx_led_count = 0;
 static uint8_t tx_led_count = 0;
+static volatile bool rx_activity = false;
+static volatile bool tx_activity = false;
+#define RX_ACTIVITY() (rx_activity = true)
+#define TX_ACTIVITY() (tx_activity = true)
+#else
+#define RX_ACTIVITY()
+#define TX_ACTIVITY()
+#endif
 
 void usb_cdc_serial_init(void)
 {
+#if (USB_CDC_SERIAL_LEDS)
     // Init Leds
     RX_LED_INIT();
     TX_LED_INIT();
@@ -67,44 +87,393 @@ void usb_cdc_serial_init(void)
     TX_LED_OFF();
     rx_led_count = 0;
     tx_led_count = 0;
+    rx_activity = false;
+    tx_activity = false;
+#endif
 }
 
 void CDC_Device_MillisecondElapsed(void)
 {
-    // Turn off leds after a few milliseconds
-    if (tx_led_count) {
+#if (USB_CDC_SERIAL_LEDS)
+    // Keep leds on for a few milliseconds after the last activity.
+    // A flag set while it is cleared here only delays the led by a frame.
+    if (tx_activity) {
+        tx_activity = false;
+        tx_led_count = TX_RX_LED_PULSE_MS;
+        TX_LED_ON();
+    }
+    else if (tx_led_count) {
         tx_led_count--;
         if (!tx_led_count) {
             TX_LED_OFF();
         }
     }
-    if (rx_led_count) {
+    if (rx_activity) {
+        rx_activity = false;
+        rx_led_count = TX_RX_LED_PULSE_MS;
+        RX_LED_ON();
+    }
+    else if (rx_led_count) {
         rx_led_count--;
         if (!rx_led_count) {
             RX_LED_OFF();
         }
     }
+#endif
+}
+
+bool usb_cdc_serial_connected(void)
+{
+    // Same conditions as CDC_Device_SendByte()
+    if ((USB_DeviceState != DEVICE_STATE_Configured)
+        || !(VirtualSerial_CDC_Interface.State.LineEncoding.BaudRateBPS)) {
+        return false;
+    }
+#if (USB_CDC_SERIAL_TX_DTR)
+    return VirtualSerial_CDC_Interface.State.ControlLineStates.HostToDevice & CDC_CONTROL_LINE_OUT_DTR;
+#else
+    return true;
+#endif
+}
+
+static uint16_t usb_cdc_serial_tx_dropped = 0;
+
+uint16_t usb_cdc_serial_dropped(void)
+{
+    return usb_cdc_serial_tx_dropped;
+}
+
+#if (USB_CDC_SERIAL_BUFFER_TX)
+static volatile uint8_t usb_cdc_serial_buffer_tx[USB_CDC_SERIAL_BUFFER_TX] = { 0 };
+static volatile uint8_t usb_cdc_serial_buffer_tx_head = 0;
+static volatile uint8_t usb_cdc_serial_buffer_tx_tail = 0;
+static bool usb_cdc_serial_zlp = false;
+static volatile bool usb_cdc_serial_tx_stalled = false;
+
+// Called on every USB start of frame by usb_cdc_serial_task().
+// Only the tail gets changed here, the head is only changed by writing.
+static void usb_cdc_serial_task_tx(void)
+{
+    // Discard data nobody is going to read
+    if (!usb_cdc_serial_connected()) {
+        usb_cdc_serial_buffer_tx_tail = usb_cdc_serial_buffer_tx_head;
+        usb_cdc_serial_zlp = false;
+        usb_cdc_serial_tx_stalled = false;
+        return;
+    }
+
+    // Fill all free banks, never wait for the host
+    Endpoint_SelectEndpoint(VirtualSerial_CDC_Interface.Config.DataINEndpoint.Address);
+    while (Endpoint_IsINReady())
+    {
+        uint8_t head = usb_cdc_serial_buffer_tx_head;
+        uint8_t tail = usb_cdc_serial_buffer_tx_tail;
+        if (head == tail)
+        {
+            // A transfer which ended with a full packet needs a zero length packet
+            if (usb_cdc_serial_zlp) {
+                Endpoint_ClearIN();
+                usb_cdc_serial_zlp = false;
+            }
+            break;
+        }
+
+        uint8_t bytes = 0;
+        do {
+            Endpoint_Write_8(usb_cdc_serial_buffer_tx[tail]);
+            tail = ((uint8_t)(tail + (uint8_t)1) % (uint8_t)USB_CDC_SERIAL_BUFFER_TX);
+            bytes++;
+        } while ((tail != head) && (bytes < CDC_TXRX_EPSIZE));
+        usb_cdc_serial_buffer_tx_tail = tail;
+        usb_cdc_serial_zlp = (bytes == CDC_TXRX_EPSIZE);
+        usb_cdc_serial_tx_stalled = false;
+        Endpoint_ClearIN();
+        TX_ACTIVITY();
+    }
+}
+
+static bool usb_cdc_serial_putchar(const uint8_t c)
+{
+    uint8_t new_index = ((uint8_t)(usb_cdc_serial_buffer_tx_head + (uint8_t)1) % (uint8_t)USB_CDC_SERIAL_BUFFER_TX);
+    if (new_index == usb_cdc_serial_buffer_tx_tail)
+    {
+#if (USB_CDC_SERIAL_TX_TIMEOUT)
+        // Wait for the start of frame interrupt to send the buffer.
+        // Give up if interrupts are disabled or the host disconnects.
+        // After a timeout do not wait again until the host reads data.
+        uint16_t start = USB_Device_GetFrameNumber();
+        while (new_index == usb_cdc_serial_buffer_tx_tail)
+        {
+#if (USB_DEFERRED_TASKS)
+            usb_task();
+#endif
+            uint16_t elapsed = (USB_Device_GetFrameNumber() - start) & 0x7FF;
+            if (usb_cdc_serial_tx_stalled || !(SREG & (1 << SREG_I)) || !usb_cdc_serial_connected()) {
+                return false;
+            }
+            if (elapsed >= USB_CDC_SERIAL_TX_TIMEOUT) {
+                usb_cdc_serial_tx_stalled = true;
+                return false;
+            }
+        }
+#else
+        return false;
+#endif
+    }
+
+    usb_cdc_serial_buffer_tx[usb_cdc_serial_buffer_tx_head] = c;
+    usb_cdc_serial_buffer_tx_head = new_index;
+    return true;
 }
 
+uint8_t usb_cdc_serial_avail_write(void)
+{
+    return ((uint8_t)((uint8_t)USB_CDC_SERIAL_BUFFER_TX - usb_cdc_serial_buffer_tx_head + \
+        usb_cdc_serial_buffer_tx_tail - (uint8_t)1) % (uint8_t)USB_CDC_SERIAL_BUFFER_TX);
+}
+
+size_t usb_cdc_serial_write(const uint8_t* buff, size_t len)
+{
+    size_t count = 0;
+    if (usb_cdc_serial_connected()) {
+        while ((count < len) && usb_cdc_serial_putchar(buff[count])) {
+            count++;
+        }
+    }
+    usb_cdc_serial_tx_dropped += len - count;
+    return count;
+}
+
+#else
+// Called on every USB start of frame by usb_cdc_serial_task().
+// Flushing may block for a long time if nobody reads the data:
+// https://github.com/abcminiuser/lufa/issues/106
+static void usb_cdc_serial_task_tx(void)
+{
+    CDC_Device_USBTask(&VirtualSerial_CDC_Interface);
+}
+
+uint8_t usb_cdc_serial_avail_write(void)
+{
+    return usb_cdc_serial_connected() ? CDC_TXRX_EPSIZE : 0;
+}
+
+size_t usb_cdc_serial_write(const uint8_t* buff, size_t len)
+{
+    if (!usb_cdc_serial_connected()
+        || CDC_Device_SendData(&VirtualSerial_CDC_Interface, buff, len) != ENDPOINT_RWSTREAM_NoError) {
+        usb_cdc_serial_tx_dropped += len;
+        return 0;
+    }
+
+    TX_ACTIVITY();
+    return len;
+}
+#endif
+
 static int usb_cdc_serial_fputc(char c, FILE* stream)
 {
-    TX_LED_ON();
-    tx_led_count = TX_RX_LED_PULSE_MS;
-	return CDC_Device_SendByte(&VirtualSerial_CDC_Interface, c) ? _FDEV_ERR : c;
+    return usb_cdc_serial_write((const uint8_t*)&c, 1) ? c : _FDEV_ERR;
 }
 
-static int usb_cdc_serial_fgetc(FILE* stream)
+static bool usb_cdc_serial_readable(void)
 {
-	int16_t ReceivedByte = CDC_Device_ReceiveByte(&VirtualSerial_CDC_Interface);
+    // Same conditions as CDC_Device_ReceiveByte()
+    return (USB_DeviceState == DEVICE_STATE_Configured)
+        && VirtualSerial_CDC_Interface.State.LineEncoding.BaudRateBPS;
+}
 
-	if (ReceivedByte < 0){
-        return _FDEV_EOF;
+#if (USB_CDC_SERIAL_BUFFER_RX)
+static volatile uint8_t usb_cdc_serial_buffer_rx[USB_CDC_SERIAL_BUFFER_RX] = { 0 };
+static volatile uint8_t usb_cdc_serial_buffer_rx_head = 0;
+static uint8_t usb_cdc_serial_buffer_rx_tail = 0;
+
+// Called on every USB start of frame by usb_cdc_serial_task().
+// Only the head gets changed here, the tail is only changed by reading.
+static void usb_cdc_serial_task_rx(void)
+{
+    if (!usb_cdc_serial_readable()) {
+        return;
+    }
+
+    // Move whole banks (or what fits) into the ring buffer. Data which does
+    // not fit stays in the endpoint and the host retries until it is read.
+    Endpoint_SelectEndpoint(VirtualSerial_CDC_Interface.Config.DataOUTEndpoint.Address);
+    while (Endpoint_IsOUTReceived())
+    {
+        uint8_t head = usb_cdc_serial_buffer_rx_head;
+        uint8_t tail = usb_cdc_serial_buffer_rx_tail;
+        uint8_t bytes = Endpoint_BytesInEndpoint();
+        while (bytes)
+        {
+            uint8_t new_index = ((uint8_t)(head + (uint8_t)1) % (uint8_t)USB_CDC_SERIAL_BUFFER_RX);
+            if (new_index == tail) {
+                break;
+            }
+            usb_cdc_serial_buffer_rx[head] = Endpoint_Read_8();
+            head = new_index;
+            bytes--;
+        }
+        if (head != usb_cdc_serial_buffer_rx_head) {
+            usb_cdc_serial_buffer_rx_head = head;
+            RX_ACTIVITY();
+        }
+
+        // Release the bank to the host if it is empty (also zero length packets)
+        if (bytes) {
+            break;
+        }
+        Endpoint_ClearOUT();
+    }
+}
+
+uint8_t usb_cdc_serial_avail_read(void)
+{
+    // Return how many bytes are available for reading
+    // No atomic block required as 1byte access is already atomic and the tail value won't change.
+    return ((uint8_t)((uint8_t)USB_CDC_SERIAL_BUFFER_RX - (uint8_t)usb_cdc_serial_buffer_rx_tail + \
+        (uint8_t)usb_cdc_serial_buffer_rx_head) % (uint8_t)USB_CDC_SERIAL_BUFFER_RX);
+}
+
+size_t usb_cdc_serial_read(uint8_t* buff, size_t len)
+{
+    // Copy all available data in (at most two) contiguous chunks.
+    // No atomic block required as 1byte access is already atomic
+    // and the SOF interrupt only writes the head, while the tail is only written here.
+    size_t count = 0;
+    uint8_t head = usb_cdc_serial_buffer_rx_head;
+    uint8_t tail = usb_cdc_serial_buffer_rx_tail;
+    while (len && (tail != head))
+    {
+        // Copy until the head or the end of the ring buffer
+        uint8_t chunk = (uint8_t)((head > tail) ? head : (uint8_t)USB_CDC_SERIAL_BUFFER_RX) - tail;
+        if (chunk > len) {
+            chunk = len;
+        }
+        len -= chunk;
+        count += chunk;
+        while (chunk--) {
+            *buff++ = usb_cdc_serial_buffer_rx[tail++];
+        }
+
+        // Wrap around
+        if (tail >= (uint8_t)USB_CDC_SERIAL_BUFFER_RX) {
+            tail = 0;
+        }
+    }
+
+    // Free the space for the SOF interrupt
+    usb_cdc_serial_buffer_rx_tail = tail;
+    return count;
+}
+
+uint8_t usb_cdc_serial_read_borrow(const uint8_t** data)
+{
+    // Return the data until the head or the end of the ring buffer.
+    // The SOF interrupt never writes between tail and head, so no copy is required.
+    uint8_t head = usb_cdc_serial_buffer_rx_head;
+    uint8_t tail = usb_cdc_serial_buffer_rx_tail;
+    *data = (const uint8_t*)&usb_cdc_serial_buffer_rx[tail];
+    return (uint8_t)((head >= tail) ? head : (uint8_t)USB_CDC_SERIAL_BUFFER_RX) - tail;
+}
+
+void usb_cdc_serial_read_release(uint8_t len)
+{
+    // Free the borrowed space for the SOF interrupt
+    uint8_t avail = usb_cdc_serial_avail_read();
+    if (len > avail) {
+        len = avail;
+    }
+    usb_cdc_serial_buffer_rx_tail = (uint8_t)(((uint16_t)usb_cdc_serial_buffer_rx_tail + len)
+        % USB_CDC_SERIAL_BUFFER_RX);
+}
+
+#else
+static void usb_cdc_serial_task_rx(void)
+{
+    // Data is read from the endpoint directly
+}
+
+uint8_t usb_cdc_serial_avail_read(void)
+{
+    if (!usb_cdc_serial_readable()) {
+        return 0;
     }
 
-    RX_LED_ON();
-    rx_led_count = TX_RX_LED_PULSE_MS;
+    // Only the current bank can be checked, the second bank follows after reading
+    uint8_t PrevSelectedEndpoint = Endpoint_GetCurrentEndpoint();
+    Endpoint_SelectEndpoint(VirtualSerial_CDC_Interface.Config.DataOUTEndpoint.Address);
+    uint8_t bytes = Endpoint_IsOUTReceived() ? Endpoint_BytesInEndpoint() : 0;
+    Endpoint_SelectEndpoint(PrevSelectedEndpoint);
+    return bytes;
+}
 
-	return ReceivedByte;
+size_t usb_cdc_serial_read(uint8_t* buff, size_t len)
+{
+    if (!usb_cdc_serial_readable()) {
+        return 0;
+    }
+
+    // Drain whole OUT endpoint banks with a single endpoint selection
+    // instead of selecting and checking the endpoint for every byte.
+    // Interrupts which select other endpoints restore the selection.
+    uint8_t PrevSelectedEndpoint = Endpoint_GetCurrentEndpoint();
+    Endpoint_SelectEndpoint(VirtualSerial_CDC_Interface.Config.DataOUTEndpoint.Address);
+
+    size_t count = 0;
+    while ((count < len) && Endpoint_IsOUTReceived())
+    {
+        // Copy as many bytes as the bank (max 64) and the buffer allow
+        uint8_t bytes = Endpoint_BytesInEndpoint();
+        if (bytes > (len - count)) {
+            bytes = len - count;
+        }
+        count += bytes;
+        while (bytes--) {
+            *buff++ = Endpoint_Read_8();
+        }
+
+        // Release the bank to the host if it is empty (also zero length packets)
+        if (!Endpoint_BytesInEndpoint()) {
+            Endpoint_ClearOUT();
+        }
+    }
+
+    Endpoint_SelectEndpoint(PrevSelectedEndpoint);
+
+    if (count) {
+        RX_ACTIVITY();
+    }
+    return count;
+}
+
+uint8_t usb_cdc_serial_read_borrow(const uint8_t** data)
+{
+    // Impossible without buffers
+    *data = NULL;
+    return 0;
+}
+
+void usb_cdc_serial_read_release(uint8_t len)
+{
+    // Nothing was borrowed
+}
+#endif
+
+// Called on every USB start of frame by the USB module
+void usb_cdc_serial_task(void)
+{
+    usb_cdc_serial_task_rx();
+    usb_cdc_serial_task_tx();
+}
+
+static int usb_cdc_serial_fgetc(FILE* stream)
+{
+    uint8_t c;
+    if (!usb_cdc_serial_read(&c, 1)) {
+        return _FDEV_EOF;
+    }
+    return c;
 }
 
 void usb_cdc_serial_init_stream(FILE* const stream)
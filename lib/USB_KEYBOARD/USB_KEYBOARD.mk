@@ -43,11 +43,17 @@ ifneq ($(filter GCC, $(DMBS_BUILD_MODULES)),)
 $(error Include this module before gcc.mk)
 endif
 
+# Default values of optionally user-supplied variables
+USB_KEYBOARD_QUEUE         ?=
+USB_KEYBOARD_NKRO          ?=
+USB_KEYBOARD_TYPE_BUFFER   ?=
+USB_KEYBOARD_LAYOUT        ?= US
+
 # Help settings
 DMBS_BUILD_MODULES         += USB_KEYBOARD
 DMBS_BUILD_TARGETS         +=
 DMBS_BUILD_MANDATORY_VARS  += DMBS_PATH
-DMBS_BUILD_OPTIONAL_VARS   +=
+DMBS_BUILD_OPTIONAL_VARS   += USB_KEYBOARD_QUEUE USB_KEYBOARD_NKRO USB_KEYBOARD_TYPE_BUFFER USB_KEYBOARD_LAYOUT
 DMBS_BUILD_PROVIDED_VARS   += USB_KEYBOARD_SRC
 DMBS_BUILD_PROVIDED_MACROS +=
 
@@ -61,7 +67,18 @@ USB_KEYBOARD_SRC = $(USB_KEYBOARD_MODULE_PATH)/src/usb_keyboard.c
 SRC                += $(USB_KEYBOARD_SRC)
 CC_FLAGS           += -DDMBS_MODULE_USB_KEYBOARD
 CC_FLAGS           += -I$(USB_KEYBOARD_MODULE_PATH)/include
-CC_FLAGS           += -DUSB_KEYBOARD_LAYOUT_US
+CC_FLAGS           += -DUSB_KEYBOARD_LAYOUT_$(USB_KEYBOARD_LAYOUT)
+
+# Optional settings
+ifneq ($(USB_KEYBOARD_QUEUE), )
+CC_FLAGS           += -DUSB_KEYBOARD_QUEUE=$(USB_KEYBOARD_QUEUE)
+endif
+ifneq ($(USB_KEYBOARD_NKRO), )
+CC_FLAGS           += -DUSB_KEYBOARD_NKRO=$(USB_KEYBOARD_NKRO)
+endif
+ifneq ($(USB_KEYBOARD_TYPE_BUFFER), )
+CC_FLAGS           += -DUSB_KEYBOARD_TYPE_BUFFER=$(USB_KEYBOARD_TYPE_BUFFER)
+endif
 
 # Phony build targets for this module
 .PHONY: $(DMBS_BUILD_TARGETS)
@@ -0,0 +1,137 @@
+/*
+Copyright (c) 2018 NicoHood
+See the readme for credit to other people.
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+THE SOFTWARE.
+*/
+
+// USB keyboard typing speed benchmark.
+// USB can't be simulated, so this runs on real hardware: open an empty text
+// editor and switch caps lock on. The device switches it off again, types the
+// test text once per key (press and release report per character) and once
+// with the typing engine, then types the achieved characters per second.
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stdio.h>
+#include <avr/io.h>
+#include <avr/interrupt.h>
+#include <avr/pgmspace.h>
+#include "usb.h"
+#include "usb_keyboard.h"
+
+// Repeated letters and shift changes, the worst cases for the typing engine
+static const char text[] PROGMEM = "The quick brown fox jumps over the lazy dog. 0123456789 Hello, Mississippi!\n";
+#define TEXT_REPEAT 4
+
+// Milliseconds from the 11 bit USB frame number, polled often enough not to miss a wrap
+static uint32_t frames;
+static uint16_t frames_last;
+
+static void frames_account(void)
+{
+    uint16_t now = USB_Device_GetFrameNumber();
+    frames += (now - frames_last) & 0x07FF;
+    frames_last = now;
+}
+
+// The remaining queue and typing buffer take far less than a frame number wrap
+static void wait_flush(void)
+{
+    usb_keyboard_flush();
+    frames_account();
+}
+
+// Old path: press and release report for every character
+static void run_write(void)
+{
+    for (uint8_t i = 0; i < TEXT_REPEAT; i++) {
+        for (const char* p = text; pgm_read_byte(p); p++) {
+            while (usb_keyboard_avail_send() < 2) {
+                usb_task();
+                frames_account();
+            }
+            usb_keyboard_write(pgm_read_byte(p));
+        }
+    }
+}
+
+// Typing engine, reports are created from the start of frame task
+static void run_type(void)
+{
+    for (uint8_t i = 0; i < TEXT_REPEAT; i++) {
+        const char* p = text;
+        while (pgm_read_byte(p)) {
+            usb_task();
+            frames_account();
+            p += usb_keyboard_type_P(p);
+        }
+    }
+}
+
+static uint32_t run(void (*fn)(void))
+{
+    frames = 0;
+    frames_last = USB_Device_GetFrameNumber();
+    fn();
+    wait_flush();
+    return frames;
+}
+
+static void report(const char* name, uint32_t ms)
+{
+    uint32_t chars = (sizeof(text) - 1) * TEXT_REPEAT;
+    char line[64];
+    snprintf_P(line, sizeof(line), PSTR("%s: chars=%lu ms=%lu cps=%lu\n"), name,
+        (unsigned long)chars, (unsigned long)ms, (unsigned long)(ms ? (chars * 1000 / ms) : 0));
+    const char* p = line;
+    while (*p) {
+        usb_task();
+        p += usb_keyboard_type(p);
+    }
+    wait_flush();
+}
+
+int main(void)
+{
+    // Initialize libraries
+    USB_Init();
+
+    // Enable interrupts
+    sei();
+
+    while (true)
+    {
+        usb_task();
+
+        // Start with caps lock on, the host sets the led state
+        if (!(usb_keyboard_read_leds() & HID_KEYBOARD_LED_CAPSLOCK)) {
+            continue;
+        }
+        usb_keyboard_write_keycode(HID_KEYBOARD_SC_CAPS_LOCK);
+        while (usb_keyboard_read_leds() & HID_KEYBOARD_LED_CAPSLOCK) {
+            usb_task();
+        }
+
+        uint32_t ms_write = run(run_write);
+        uint32_t ms_type = run(run_type);
+        report("write", ms_write);
+        report("type", ms_type);
+    }
+}
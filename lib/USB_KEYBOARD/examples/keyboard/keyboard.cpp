@@ -52,6 +52,9 @@ int main(void)
 
     while(true)
     {
+        // Send HID reports if USB_DEFERRED_TASKS is set
+        usb_task();
+
         // Test keyboard leds
         // uint8_t leds = usb_keyboard_read_leds();
         // if(leds & HID_KEYBOARD_LED_CAPSLOCK) {
@@ -84,6 +87,9 @@ int main(void)
 
                 // Stdio functionallity
                 fprintf(&UsbKeyboardStream, "Hello Keyboard!\n");
+
+                // Keep the led on until the host received the whole text
+                usb_keyboard_flush();
             }
 
             // Wakeup PC from suspend
@@ -35,27 +35,75 @@ extern "C" {
 #include <stdio.h>
 #include <LUFA/Drivers/USB/Class/Common/HIDClassCommon.h>
 
-// Select keyboard layout
-#ifdef USB_KEYBOARD_LAYOUT_US
+// N-key rollover: a bitmap report with one bit per key, so any number of keys
+// can be pressed at once. Keycodes 0x78 and above (except modifiers) are not
+// supported then. Hosts which select the boot protocol (BIOS) receive the
+// standard 6 key report instead.
+#ifndef USB_KEYBOARD_NKRO
+#define USB_KEYBOARD_NKRO 0
+#endif
+
+// Default report queue size in reports (8 bytes RAM each, 16 with NKRO).
+// Every press and release queues a report, the host takes one per poll interval.
+#ifndef USB_KEYBOARD_QUEUE
+#define USB_KEYBOARD_QUEUE 8
+#endif
+
+// Default typing buffer size in characters, see usb_keyboard_type()
+#ifndef USB_KEYBOARD_TYPE_BUFFER
+#define USB_KEYBOARD_TYPE_BUFFER 32
+#endif
+
+// Select keyboard layout, only its tables get linked. The host must use the same layout.
+// US types ASCII, DE and FR also type Latin-1 characters (with AltGr and dead keys) and the euro sign.
+#if defined(USB_KEYBOARD_LAYOUT_US) + defined(USB_KEYBOARD_LAYOUT_DE) + defined(USB_KEYBOARD_LAYOUT_FR) > 1
+#error "Multiple keyboard layouts selected."
+#elif defined(USB_KEYBOARD_LAYOUT_US)
 #define USB_keyboardAsciiMap USB_keyboardAsciiMapUs
+#elif defined(USB_KEYBOARD_LAYOUT_DE)
+#define USB_keyboardAsciiMap USB_keyboardAsciiMapDe
+#define USB_keyboardDeadKeys USB_keyboardDeadKeysDe
+#elif defined(USB_KEYBOARD_LAYOUT_FR)
+#define USB_keyboardAsciiMap USB_keyboardAsciiMapFr
+#define USB_keyboardDeadKeys USB_keyboardDeadKeysFr
 #else
 #warning "No valid keyboard layout selected. Falling back to USB_KEYBOARD_LAYOUT_US."
+#define USB_KEYBOARD_LAYOUT_US
 #define USB_keyboardAsciiMap USB_keyboardAsciiMapUs
 #endif
 
 /*
 Common return values for keyboard API:
-    -2 = Full report buffer or invalid keycode (_FDEV_EOF)
+    -2 = Full report buffer or queue, or invalid keycode (_FDEV_EOF)
     -1 = USB error (_FDEV_ERR)
      0 = OK, key already pressed/released nothing to send/released
      1 = OK, 1 key sent/released
      n = OK, n keys sent/released
 */
 
-// Function for sending the keyreport
+// Function for queuing the keyreport, it is sent in the background.
+// Reports that do not fit into the queue are counted as dropped.
+// Text typed before with usb_keyboard_type() or the stream is sent first.
 int8_t usb_keyboard_send(void);
-
-// Functions to modify the keyreport
+uint8_t usb_keyboard_avail_send(void);
+uint16_t usb_keyboard_dropped(void);
+
+// Waits until the host received all queued reports and typed characters
+int8_t usb_keyboard_flush(void);
+
+// Types text in the background, from RAM or PROGMEM. Every character takes a
+// single report which also releases the previous key, only repeated keys need
+// an extra release. Keys held with usb_keyboard_press() stay pressed in typed
+// reports. Typed text and queued reports are sent in the order they were
+// scheduled, without blocking. The text is UTF-8 encoded, characters
+// without key in the selected layout are skipped.
+// Returns the number of characters that fit into the buffer.
+size_t usb_keyboard_type(const char* str);
+size_t usb_keyboard_type_P(const char* str);
+uint8_t usb_keyboard_avail_type(void);
+
+// Functions to modify the keyreport.
+// Characters are ASCII or Latin-1, dead key characters can only be typed.
 int8_t usb_keyboard_add_keycode(uint8_t k);
 int8_t usb_keyboard_add(char c);
 int8_t usb_keyboard_remove_keycode(uint8_t k);
@@ -76,7 +124,7 @@ int8_t usb_keyboard_release_all(void);
 int8_t usb_keyboard_write_keycode(uint8_t k);
 int8_t usb_keyboard_write(char c);
 
-// Stream functions
+// Stream functions, the UTF-8 output is typed in the background
 void usb_keyboard_init_stream(FILE* const stream);
 
 // Get led state
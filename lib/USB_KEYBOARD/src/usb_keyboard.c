@@ -21,12 +21,26 @@ OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
 THE SOFTWARE.
 */
 
-#include "usb_descriptors.h"
+#include "usb.h"
 
 #include <util/atomic.h>
 #include "usb_keyboard.h"
 #include "usb_keyboard_ascii_maps.h"
 
+#if (USB_KEYBOARD_NKRO)
+// N-key rollover report with one bit per key, see KeyboardReport in usb_descriptors.c
+typedef struct
+{
+    uint8_t Modifier;
+    uint8_t Keys[USB_KEYBOARD_NKRO_KEYS / 8];
+} ATTR_PACKED usb_keyboard_report_t;
+#else
+typedef USB_KeyboardReport_Data_t usb_keyboard_report_t;
+#endif
+
+_Static_assert(sizeof(usb_keyboard_report_t) <= KEYBOARD_EPSIZE,
+    "The keyboard report does not fit into the endpoint.");
+
 /** LUFA HID Class driver interface configuration and state information. This structure is
  *  passed to all HID Class driver functions, so that multiple instances of the same class
  *  within a device can be differentiated from one another.
@@ -43,30 +57,272 @@ USB_ClassInfo_HID_Device_t Keyboard_HID_Interface =
                         .Banks                  = 1,
                     },
                 .PrevReportINBuffer             = NULL,
-                .PrevReportINBufferSize         = sizeof(USB_KeyboardReport_Data_t),
+                .PrevReportINBufferSize         = sizeof(usb_keyboard_report_t),
             },
     };
 
-// Keyboard report data and flag for sending it to the USB host
-// Two buffers are required to not interrupt the API while modifying the report.
-// Otherwise interrupts need to be disabled in every modification of the report.
-static USB_KeyboardReport_Data_t USB_KeyboardReport_Data = { 0 };
-static USB_KeyboardReport_Data_t USB_KeyboardReport_Data_Buffer = { 0 };
+// Reports are addressed with free running 8 bit counters,
+// so the queue can be filled completely without an extra free slot.
+_Static_assert(USB_KEYBOARD_QUEUE && !(USB_KEYBOARD_QUEUE & (USB_KEYBOARD_QUEUE - 1))
+    && USB_KEYBOARD_QUEUE <= 128,
+    "USB_KEYBOARD_QUEUE must be a power of two. Please choose 1, 2, 4, 8, 16, 32, 64 or 128");
+
+// Keyboard report data which gets modified by the API.
+// usb_keyboard_send() queues snapshots of it, which are sent one per poll
+// interval from the start of frame task. The last sent report is kept for
+// GET_REPORT requests and idle repeats. The last report taken from the queue
+// is kept as the held keys, which the typer adds to every typed report.
+// Every queued report marks the typing buffer position at the time it was
+// queued, text typed before it is sent first.
+static usb_keyboard_report_t USB_KeyboardReport_Data = { 0 };
+static usb_keyboard_report_t USB_KeyboardReport_Sent = { 0 };
+static usb_keyboard_report_t USB_KeyboardReport_Held = { 0 };
+static usb_keyboard_report_t USB_KeyboardReport_Queue[USB_KEYBOARD_QUEUE];
+static uint8_t USB_KeyboardReport_Queue_Mark[USB_KEYBOARD_QUEUE];
+static volatile uint8_t USB_KeyboardReport_Queue_Head = 0;
+static volatile uint8_t USB_KeyboardReport_Queue_Tail = 0;
+static uint16_t USB_KeyboardReport_Dropped = 0;
 static uint8_t USB_KeyboardReport_Leds = 0x00;
-static bool sendnow = false;
 
-bool CALLBACK_HID_Keyboard_CreateHIDReport(USB_KeyboardReport_Data_t* ReportData)
+// Characters scheduled by usb_keyboard_type(), typed from the start of frame
+// task up to the mark of the next queued report. The key currently pressed by
+// the typer (with modifier flags) is remembered to release it only when
+// necessary. The decoded character waits in Next until all its keys are typed.
+// The typer state is only changed from the start of frame task.
+_Static_assert(USB_KEYBOARD_TYPE_BUFFER && !(USB_KEYBOARD_TYPE_BUFFER & (USB_KEYBOARD_TYPE_BUFFER - 1))
+    && USB_KEYBOARD_TYPE_BUFFER <= 128,
+    "USB_KEYBOARD_TYPE_BUFFER must be a power of two. Please choose 1, 2, 4, 8, 16, 32, 64 or 128");
+static char USB_Keyboard_Type_Buffer[USB_KEYBOARD_TYPE_BUFFER];
+static volatile uint8_t USB_Keyboard_Type_Head = 0;
+static volatile uint8_t USB_Keyboard_Type_Tail = 0;
+static uint16_t USB_Keyboard_Type_Key = 0;
+static uint16_t USB_Keyboard_Type_Next = 0;
+static uint16_t USB_Keyboard_Type_Code = 0;
+static uint8_t USB_Keyboard_Type_Follow = 0;
+
+bool usb_keyboard_configure(void)
+{
+    // Discard reports of a previous connection
+    USB_KeyboardReport_Queue_Tail = USB_KeyboardReport_Queue_Head;
+    USB_Keyboard_Type_Tail = USB_Keyboard_Type_Head;
+    USB_Keyboard_Type_Key = 0;
+    USB_Keyboard_Type_Next = 0;
+    USB_Keyboard_Type_Follow = 0;
+    memset(&USB_KeyboardReport_Sent, 0, sizeof(USB_KeyboardReport_Sent));
+    memset(&USB_KeyboardReport_Held, 0, sizeof(USB_KeyboardReport_Held));
+
+    return HID_Device_ConfigureEndpoints(&Keyboard_HID_Interface);
+}
+
+#if (USB_KEYBOARD_NKRO)
+// Converts the bitmap into the boot protocol report with up to 6 keys.
+// More keys are reported as rollover error, like the HID specification requires.
+static void usb_keyboard_boot_report(const usb_keyboard_report_t* report, USB_KeyboardReport_Data_t* boot)
 {
-    // Copy report data
-    memcpy(ReportData, &USB_KeyboardReport_Data_Buffer, sizeof(USB_KeyboardReport_Data_Buffer));
+    memset(boot, 0, sizeof(*boot));
+    boot->Modifier = report->Modifier;
 
-    // Make sure to send the report now if we are waiting for it
-    if(sendnow)
+    uint8_t count = 0;
+    for (uint8_t i = 0; i < sizeof(report->Keys); i++)
     {
-        sendnow = false;
+        uint8_t k = i * 8;
+        for (uint8_t bits = report->Keys[i]; bits; bits >>= 1, k++)
+        {
+            if (!(bits & 0x01)) {
+                continue;
+            }
+            if (count >= sizeof(boot->KeyCode)) {
+                memset(boot->KeyCode, HID_KEYBOARD_SC_ERROR_ROLLOVER, sizeof(boot->KeyCode));
+                return;
+            }
+            boot->KeyCode[count++] = k;
+        }
+    }
+}
+#endif
+
+// Adds a key to a report, see usb_keyboard_add_keycode()
+static int8_t usb_keyboard_report_add(usb_keyboard_report_t* report, uint8_t k)
+{
+    // It's a modifier key
+    if(k >= HID_KEYBOARD_SC_LEFT_CONTROL && k <= HID_KEYBOARD_SC_RIGHT_GUI)
+    {
+        // Convert key into bitfield (0 - 7)
+        k -= HID_KEYBOARD_SC_LEFT_CONTROL;
+
+        // Check if key is already present
+        if (report->Modifier & (1 << k)){
+            return 0;
+        }
+
+        // Add key
+        report->Modifier |= (1 << k);
+        return 1;
+    }
+
+#if (USB_KEYBOARD_NKRO)
+    // Keys outside of the bitmap can't be reported
+    if (k >= USB_KEYBOARD_NKRO_KEYS) {
+        return _FDEV_EOF;
+    }
+
+    // Check if key is already present
+    uint8_t* keys = &report->Keys[k / 8];
+    uint8_t bit = 1 << (k % 8);
+    if (*keys & bit) {
+        return 0;
+    }
+
+    // Add key
+    *keys |= bit;
+    return 1;
+#else
+    // Search for the first empty keyslot and add keycode
+    for(uint8_t i = 0; i < sizeof(report->KeyCode); i++)
+    {
+        // Check for an empty slot
+        if (!report->KeyCode[i]){
+            report->KeyCode[i] = k;
+            return 1;
+        }
+
+        // Check if key is already present
+        if(report->KeyCode[i] == k){
+            return 0;
+        }
+    }
+
+    // No free slot found
+    return _FDEV_EOF;
+#endif
+}
+
+// Looks up the map entry of a unicode character in constant time, 0 if the layout has no key for it
+static uint16_t usb_keyboard_unicode_key(uint16_t c)
+{
+    if (c < (sizeof(USB_keyboardAsciiMap) / sizeof(USB_keyboardAsciiMap[0]))) {
+        return pgm_read_word(USB_keyboardAsciiMap + c);
+    }
+#ifdef USB_KEYBOARD_EURO
+    if (c == UNICODE_EURO_SIGN) {
+        return USB_KEYBOARD_EURO;
+    }
+#endif
+    return 0;
+}
+
+// Creates the next report of the text typed before the limit position into the
+// sent report, returns false if there is nothing to type (all keys released).
+// Every key takes a single report, which presses it and releases the previous
+// one at the same time. Only repeated keys need a release report before.
+static bool usb_keyboard_type_report(uint8_t limit)
+{
+    // Decode UTF-8 until the next character with key. Sequences may arrive
+    // in parts, invalid and 4 byte sequences are skipped.
+    uint8_t tail = USB_Keyboard_Type_Tail;
+    while (!USB_Keyboard_Type_Next && (tail != limit))
+    {
+        uint8_t c = USB_Keyboard_Type_Buffer[tail++ & (USB_KEYBOARD_TYPE_BUFFER - 1)];
+        if (USB_Keyboard_Type_Follow && ((c & 0xC0) == 0x80))
+        {
+            USB_Keyboard_Type_Code = (USB_Keyboard_Type_Code << 6) | (c & 0x3F);
+            if (--USB_Keyboard_Type_Follow) {
+                continue;
+            }
+        }
+        else if (c < 0x80) {
+            USB_Keyboard_Type_Code = c;
+            USB_Keyboard_Type_Follow = 0;
+        }
+        else
+        {
+            USB_Keyboard_Type_Follow = 0;
+            if ((c & 0xE0) == 0xC0) {
+                USB_Keyboard_Type_Code = c & 0x1F;
+                USB_Keyboard_Type_Follow = 1;
+            }
+            else if ((c & 0xF0) == 0xE0) {
+                USB_Keyboard_Type_Code = c & 0x0F;
+                USB_Keyboard_Type_Follow = 2;
+            }
+            continue;
+        }
+        USB_Keyboard_Type_Next = usb_keyboard_unicode_key(USB_Keyboard_Type_Code);
+    }
+    USB_Keyboard_Type_Tail = tail;
+
+    // Type the dead key first, the character's own key follows in the next report
+    uint16_t k = USB_Keyboard_Type_Next;
+#ifdef USB_keyboardDeadKeys
+    uint8_t dead = DEAD_INDEX(k);
+    if (dead) {
+        k = pgm_read_word(USB_keyboardDeadKeys + dead - 1);
+    }
+#endif
+
+    // Release the key after the text, or before pressing it again.
+    // The release returns to the held keys, which stay pressed while typing.
+    usb_keyboard_report_t* report = &USB_KeyboardReport_Sent;
+    if (!k || !((k ^ USB_Keyboard_Type_Key) & KEYCODE_MASK))
+    {
+        if (!USB_Keyboard_Type_Key) {
+            return false;
+        }
+        memcpy(report, &USB_KeyboardReport_Held, sizeof(*report));
+        USB_Keyboard_Type_Key = 0;
         return true;
     }
-    return false;
+
+    // Modifiers change in the same report, hosts apply them before the keys
+    memcpy(report, &USB_KeyboardReport_Held, sizeof(*report));
+    if (k & SHIFT) {
+        report->Modifier |= HID_KEYBOARD_MODIFIER_LEFTSHIFT;
+    }
+    if (k & ALTGR) {
+        report->Modifier |= HID_KEYBOARD_MODIFIER_RIGHTALT;
+    }
+    usb_keyboard_report_add(report, k & KEYCODE_MASK);
+    USB_Keyboard_Type_Key = k;
+    USB_Keyboard_Type_Next = (k == USB_Keyboard_Type_Next) ? 0 : (USB_Keyboard_Type_Next & ~DEAD_MASK);
+    return true;
+}
+
+bool CALLBACK_HID_Keyboard_CreateHIDReport(uint8_t* ReportData, uint16_t* const ReportSize)
+{
+    // Only the interrupt endpoint takes reports from the queue or the typer,
+    // GET_REPORT requests on the control endpoint read the last sent report.
+    bool next = false;
+    if (Endpoint_GetCurrentEndpoint() == KEYBOARD_EPADDR)
+    {
+        // Type the text scheduled before the next queued report first
+        uint8_t tail = USB_KeyboardReport_Queue_Tail;
+        bool queued = (tail != USB_KeyboardReport_Queue_Head);
+        uint8_t limit = queued ? USB_KeyboardReport_Queue_Mark[tail & (USB_KEYBOARD_QUEUE - 1)] : USB_Keyboard_Type_Head;
+        next = usb_keyboard_type_report(limit);
+        if (!next && queued)
+        {
+            memcpy(&USB_KeyboardReport_Sent, &USB_KeyboardReport_Queue[tail & (USB_KEYBOARD_QUEUE - 1)],
+                sizeof(USB_KeyboardReport_Sent));
+            memcpy(&USB_KeyboardReport_Held, &USB_KeyboardReport_Sent, sizeof(USB_KeyboardReport_Held));
+            USB_KeyboardReport_Queue_Tail = tail + 1;
+            next = true;
+        }
+    }
+
+#if (USB_KEYBOARD_NKRO)
+    // The host selects the boot protocol with SET_PROTOCOL, if it can't parse the report descriptor
+    if (!Keyboard_HID_Interface.State.UsingReportProtocol)
+    {
+        usb_keyboard_boot_report(&USB_KeyboardReport_Sent, (USB_KeyboardReport_Data_t*)ReportData);
+        *ReportSize = sizeof(USB_KeyboardReport_Data_t);
+        return next;
+    }
+#endif
+
+    // Force sending a new report, even if it equals the last one
+    memcpy(ReportData, &USB_KeyboardReport_Sent, sizeof(USB_KeyboardReport_Sent));
+    *ReportSize = sizeof(USB_KeyboardReport_Sent);
+    return next;
 }
 
 void CALLBACK_HID_Keyboard_ProcessHIDReport(uint8_t* leds)
@@ -83,99 +339,156 @@ void usb_keybord_dump_report(void)
 {
     // Print modifiers first, then all keycodes. Ignore reserved byte.
     printf("Modifiers: %X\n", USB_KeyboardReport_Data.Modifier);
+#if (USB_KEYBOARD_NKRO)
+    for (uint8_t i = 0; i < sizeof(USB_KeyboardReport_Data.Keys); i++) {
+        printf("Keys %02X: %02X\n", i * 8, USB_KeyboardReport_Data.Keys[i]);
+    }
+#else
     for (uint8_t i = 0; i < sizeof(USB_KeyboardReport_Data.KeyCode); i++) {
         printf("Key %d: %X\n", i, USB_KeyboardReport_Data.KeyCode[i]);
     }
+#endif
+}
+
+// Checks if typed text or the release of its last key is not sent yet.
+// The typer state is changed by the start of frame task, call this with interrupts disabled.
+static bool usb_keyboard_type_busy(void)
+{
+    return (USB_Keyboard_Type_Tail != USB_Keyboard_Type_Head)
+        || USB_Keyboard_Type_Next || USB_Keyboard_Type_Key;
+}
+
+uint8_t usb_keyboard_avail_send(void)
+{
+    return USB_KEYBOARD_QUEUE - (uint8_t)(USB_KeyboardReport_Queue_Head - USB_KeyboardReport_Queue_Tail);
+}
+
+uint16_t usb_keyboard_dropped(void)
+{
+    return USB_KeyboardReport_Dropped;
 }
 
 int8_t usb_keyboard_send(void)
 {
-    // Copy report data
-    ATOMIC_BLOCK(ATOMIC_RESTORESTATE) {
-        memcpy(&USB_KeyboardReport_Data_Buffer, &USB_KeyboardReport_Data, sizeof(USB_KeyboardReport_Data));
+    // Do not queue reports for a disconnected host
+    if (USB_DeviceState != DEVICE_STATE_Configured){
+        return _FDEV_ERR;
     }
 
-    // Send the keyreport now. This function is blocking.
-    sendnow = true;
-    do{
-        // Do not loop forever if the UB device disconnected
-        if (USB_DeviceState != DEVICE_STATE_Configured){
-            return _FDEV_ERR;
-        }
-
-        // The HID USBTask will call CALLBACK_HID_Keyboard_CreateHIDReport
-        // which will unset 'sendnow' if the report was sent.
-        HID_Device_USBTask(&Keyboard_HID_Interface);
+    // The report stays modified and gets sent with the next successful call
+    if (!usb_keyboard_avail_send()) {
+        USB_KeyboardReport_Dropped++;
+        return _FDEV_EOF;
     }
-    while(sendnow);
+
+    // Copy first, the report is sent after the head moved.
+    // Text typed so far is sent before the report.
+    uint8_t head = USB_KeyboardReport_Queue_Head;
+    memcpy(&USB_KeyboardReport_Queue[head & (USB_KEYBOARD_QUEUE - 1)], &USB_KeyboardReport_Data,
+        sizeof(USB_KeyboardReport_Data));
+    USB_KeyboardReport_Queue_Mark[head & (USB_KEYBOARD_QUEUE - 1)] = USB_Keyboard_Type_Head;
+    USB_KeyboardReport_Queue_Head = head + 1;
 
     // No error
     return 0;
 }
 
-int8_t usb_keyboard_add_keycode(uint8_t k)
+int8_t usb_keyboard_flush(void)
 {
-    // It's a modifier key
-    if(k >= HID_KEYBOARD_SC_LEFT_CONTROL && k <= HID_KEYBOARD_SC_RIGHT_GUI)
+    // Wait until the host took every queued report and typed character out of the endpoint
+    while (true)
     {
-        // Convert key into bitfield (0 - 7)
-        k -= HID_KEYBOARD_SC_LEFT_CONTROL;
+        // Do not loop forever if the USB device disconnected
+        if (USB_DeviceState != DEVICE_STATE_Configured){
+            return _FDEV_ERR;
+        }
 
-        // Check if key is already present
-        if (USB_KeyboardReport_Data.Modifier & (1 << k)){
+        // Send reports if USB_DEFERRED_TASKS is set
+        usb_task();
+
+        bool sent;
+        ATOMIC_BLOCK(ATOMIC_RESTORESTATE)
+        {
+            uint8_t PrevSelectedEndpoint = Endpoint_GetCurrentEndpoint();
+            Endpoint_SelectEndpoint(KEYBOARD_EPADDR);
+            sent = (USB_KeyboardReport_Queue_Tail == USB_KeyboardReport_Queue_Head)
+                && !usb_keyboard_type_busy() && Endpoint_IsINReady();
+            Endpoint_SelectEndpoint(PrevSelectedEndpoint);
+        }
+        if (sent) {
             return 0;
         }
+    }
+}
 
-        // Add key
-        USB_KeyboardReport_Data.Modifier |= (1 << k);
-        return 1;
+uint8_t usb_keyboard_avail_type(void)
+{
+    return USB_KEYBOARD_TYPE_BUFFER - (uint8_t)(USB_Keyboard_Type_Head - USB_Keyboard_Type_Tail);
+}
+
+// Schedules characters from RAM or flash, returns the number of characters taken
+static size_t usb_keyboard_type_buffer(const char* str, bool progmem)
+{
+    if (USB_DeviceState != DEVICE_STATE_Configured){
+        return 0;
     }
 
-    // Search for the first empty keyslot and add keycode
-    for(uint8_t i = 0; i < sizeof(USB_KeyboardReport_Data.KeyCode); i++)
+    // Copy first, the characters are typed after the head moved
+    size_t count = 0;
+    uint8_t head = USB_Keyboard_Type_Head;
+    uint8_t avail = usb_keyboard_avail_type();
+    while (count < avail)
     {
-        // Check for an empty slot
-        if (!USB_KeyboardReport_Data.KeyCode[i]){
-            USB_KeyboardReport_Data.KeyCode[i] = k;
-            return 1;
-        }
-
-        // Check if key is already present
-        if(USB_KeyboardReport_Data.KeyCode[i] == k){
-            return 0;
+        char c = progmem ? pgm_read_byte(str + count) : str[count];
+        if (!c) {
+            break;
         }
+        USB_Keyboard_Type_Buffer[head++ & (USB_KEYBOARD_TYPE_BUFFER - 1)] = c;
+        count++;
     }
+    USB_Keyboard_Type_Head = head;
+    return count;
+}
 
-    // No free slot found
-    return _FDEV_EOF;
+size_t usb_keyboard_type(const char* str)
+{
+    return usb_keyboard_type_buffer(str, false);
 }
 
-int8_t usb_keyboard_add(char c)
+size_t usb_keyboard_type_P(const char* str)
 {
-    // Ignore invalid input
-    if (c >= sizeof(USB_keyboardAsciiMap)) {
-        return _FDEV_EOF;
-    }
+    return usb_keyboard_type_buffer(str, true);
+}
+
+int8_t usb_keyboard_add_keycode(uint8_t k)
+{
+    return usb_keyboard_report_add(&USB_KeyboardReport_Data, k);
+}
 
-    // Read keycode from AsciiMap. Might contain a shift modifier
-    uint8_t k = pgm_read_byte(USB_keyboardAsciiMap + c);
+int8_t usb_keyboard_add(char c)
+{
+    // Read keycode from AsciiMap. Might contain shift and AltGr modifiers
+    uint16_t k = usb_keyboard_unicode_key((uint8_t)c);
 
-    // Check for valid keycode
-    if (!k) {
+    // Check for valid keycode, dead keys need two reports
+    if (!k || (k & DEAD_MASK)) {
         return _FDEV_EOF;
     }
 
     // Add normal keycode first. Stop if keyreport is full.
-    int8_t ret = usb_keyboard_add_keycode(k & ~SHIFT);
+    int8_t ret = usb_keyboard_add_keycode(k & KEYCODE_MASK);
     if (ret < 0) {
         return ret;
     }
 
-    // Add shift to modifier keys
-    // The shift key is always available, the function can only return 0 or 1.
+    // Add shift and AltGr to modifier keys
+    // Modifier keys are always available, the function can only return 0 or 1.
     if (k & SHIFT) {
         ret += usb_keyboard_add_keycode(HID_KEYBOARD_SC_LEFT_SHIFT);
     }
+    if (k & ALTGR) {
+        ret += usb_keyboard_add_keycode(HID_KEYBOARD_SC_RIGHT_ALT);
+    }
 
     // Return number of newly pressed keys
     return ret;
@@ -238,6 +551,20 @@ int8_t usb_keyboard_remove_keycode(uint8_t k)
         return ret;
     }
 
+#if (USB_KEYBOARD_NKRO)
+    // Keys outside of the bitmap can't be pressed
+    if (k >= USB_KEYBOARD_NKRO_KEYS) {
+        return 0;
+    }
+
+    // Check if key is already present
+    uint8_t* keys = &USB_KeyboardReport_Data.Keys[k / 8];
+    uint8_t bit = 1 << (k % 8);
+    ret = (bool)(*keys & bit);
+
+    // Remove key
+    *keys &= ~bit;
+#else
     // Search for the key and remove keycode
     for(uint8_t i = 0; i < sizeof(USB_KeyboardReport_Data.KeyCode); i++)
     {
@@ -246,9 +573,11 @@ int8_t usb_keyboard_remove_keycode(uint8_t k)
             break;
         }
 
-        // Reorder all other keys to make add() function properly
+        // Reorder all other keys to make add() function properly.
+        // Clear the moved slot, the last one of a full report stays empty then.
         if (ret) {
             USB_KeyboardReport_Data.KeyCode[i - 1] = USB_KeyboardReport_Data.KeyCode[i];
+            USB_KeyboardReport_Data.KeyCode[i] = HID_KEYBOARD_SC_RESERVED;
             continue;
         }
 
@@ -260,6 +589,7 @@ int8_t usb_keyboard_remove_keycode(uint8_t k)
             ret = 1;
         }
     }
+#endif
 
     // Return if keycode got released
     return ret;
@@ -267,26 +597,24 @@ int8_t usb_keyboard_remove_keycode(uint8_t k)
 
 int8_t usb_keyboard_remove(char c)
 {
-    // Ignore invalid input
-    if (c >= sizeof(USB_keyboardAsciiMap)) {
-        return _FDEV_EOF;
-    }
-
-    // Read keycode from AsciiMap. Might contain a shift modifier
-    uint8_t k = pgm_read_byte(USB_keyboardAsciiMap + c);
+    // Read keycode from AsciiMap. Might contain shift and AltGr modifiers
+    uint16_t k = usb_keyboard_unicode_key((uint8_t)c);
 
-    // Check for valid keycode
-    if (!k) {
+    // Check for valid keycode, dead keys need two reports
+    if (!k || (k & DEAD_MASK)) {
         return _FDEV_EOF;
     }
 
     // Remove normal keycode first
-    int8_t ret = usb_keyboard_remove_keycode(k & ~SHIFT);
+    int8_t ret = usb_keyboard_remove_keycode(k & KEYCODE_MASK);
 
-    // Remove shift modifier
+    // Remove shift and AltGr modifiers
     if (k & SHIFT) {
         ret += usb_keyboard_remove_keycode(HID_KEYBOARD_SC_LEFT_SHIFT);
     }
+    if (k & ALTGR) {
+        ret += usb_keyboard_remove_keycode(HID_KEYBOARD_SC_RIGHT_ALT);
+    }
 
     // Return number of removed keys
     return ret;
@@ -363,7 +691,8 @@ int8_t usb_keyboard_write(char c)
 int8_t usb_keyboard_clear(void)
 {
     // Clear all report data. Used on device (re)connect.
-    int8_t ret = 0;
+    // With NKRO all keys together exceed the return value, limit the count then.
+    uint8_t ret = 0;
 
     // Count all pressed modifier keys
     while(USB_KeyboardReport_Data.Modifier)
@@ -374,6 +703,19 @@ int8_t usb_keyboard_clear(void)
         USB_KeyboardReport_Data.Modifier >>= 1;
     }
 
+#if (USB_KEYBOARD_NKRO)
+    // Count all released keys of the bitmap
+    for (uint8_t i = 0; i < sizeof(USB_KeyboardReport_Data.Keys); i++)
+    {
+        for (uint8_t bits = USB_KeyboardReport_Data.Keys[i]; bits; bits >>= 1)
+        {
+            if (bits & 0x01) {
+                ret++;
+            }
+        }
+        USB_KeyboardReport_Data.Keys[i] = 0x00;
+    }
+#else
     // Count all released keycodes
     for (uint8_t i = 0; i < sizeof(USB_KeyboardReport_Data.KeyCode); i++)
     {
@@ -382,7 +724,8 @@ int8_t usb_keyboard_clear(void)
         }
         USB_KeyboardReport_Data.KeyCode[i] = 0x00;
     }
-    return ret;
+#endif
+    return (ret > INT8_MAX) ? INT8_MAX : ret;
 }
 
 int8_t usb_keyboard_release_all(void)
@@ -402,10 +745,20 @@ int8_t usb_keyboard_release_all(void)
 
 static int usb_keyboard_fputc(char c, FILE *stream)
 {
-    int8_t ret = usb_keyboard_write(c);
-    if (ret < 0) {
+    // Ignore invalid ASCII input, UTF-8 sequences are checked while typing
+    if (((uint8_t)c < 0x80) && !usb_keyboard_unicode_key(c)) {
         return _FDEV_EOF;
     }
+
+    // Type in the background, stdio output only blocks if it is faster than the host
+    const char str[2] = { c, '\0' };
+    while (!usb_keyboard_type(str))
+    {
+        if (USB_DeviceState != DEVICE_STATE_Configured){
+            return _FDEV_EOF;
+        }
+        usb_task();
+    }
     return c;
 }
 
@@ -26,8 +26,27 @@ THE SOFTWARE.
 #include <avr/pgmspace.h>
 #include <LUFA/Drivers/USB/Class/Common/HIDClassCommon.h>
 
-#define SHIFT 0x80
-static const uint8_t USB_keyboardAsciiMapUs[] PROGMEM =
+// Map entries hold the keycode and the modifiers to press with it. Characters
+// of a dead key are typed as two keys: the dead key of the layout first
+// (see USB_keyboardDeadKeys), then the keycode of the entry.
+#define KEYCODE_MASK    0x007F
+#define SHIFT           0x0080
+#define ALTGR           0x0100
+#define DEAD_MASK       0x0E00
+#define DEAD_INDEX(k)   (((k) >> 9) & 0x07)
+#define DEAD_CIRCUMFLEX (1 << 9)
+#define DEAD_ACUTE      (2 << 9)
+#define DEAD_GRAVE      (3 << 9)
+#define DEAD_DIAERESIS  (4 << 9)
+#define DEAD_TILDE      (5 << 9)
+
+// The maps are indexed by the unicode code point, characters above the
+// map size are not supported except the euro sign (USB_KEYBOARD_EURO).
+#define UNICODE_EURO_SIGN 0x20AC
+
+#if defined(USB_KEYBOARD_LAYOUT_US)
+// US layout, ASCII only
+static const uint16_t USB_keyboardAsciiMapUs[] PROGMEM =
 {
     HID_KEYBOARD_SC_RESERVED,                                   // NUL
     HID_KEYBOARD_SC_RESERVED,                                   // SOH
@@ -159,3 +178,554 @@ static const uint8_t USB_keyboardAsciiMapUs[] PROGMEM =
     HID_KEYBOARD_SC_NON_US_HASHMARK_AND_TILDE|SHIFT,            // ~
     HID_KEYBOARD_SC_RESERVED                                    // DEL
 };
+
+#elif defined(USB_KEYBOARD_LAYOUT_DE)
+// German QWERTZ layout (T1), Latin-1
+static const uint16_t USB_keyboardAsciiMapDe[] PROGMEM =
+{
+    HID_KEYBOARD_SC_RESERVED,                                   // NUL
+    HID_KEYBOARD_SC_RESERVED,                                   // SOH
+    HID_KEYBOARD_SC_RESERVED,                                   // STX
+    HID_KEYBOARD_SC_RESERVED,                                   // ETX
+    HID_KEYBOARD_SC_RESERVED,                                   // EOT
+    HID_KEYBOARD_SC_RESERVED,                                   // ENQ
+    HID_KEYBOARD_SC_RESERVED,                                   // ACK
+    HID_KEYBOARD_SC_RESERVED,                                   // BEL
+    HID_KEYBOARD_SC_BACKSPACE,                                  // BS Backspace
+    HID_KEYBOARD_SC_TAB,                                        // TAB    Tab
+    HID_KEYBOARD_SC_ENTER,                                      // LF Enter
+    HID_KEYBOARD_SC_RESERVED,                                   // VT
+    HID_KEYBOARD_SC_RESERVED,                                   // FF
+    HID_KEYBOARD_SC_RESERVED,                                   // CR
+    HID_KEYBOARD_SC_RESERVED,                                   // SO
+    HID_KEYBOARD_SC_RESERVED,                                   // SI
+    HID_KEYBOARD_SC_RESERVED,                                   // DEL
+    HID_KEYBOARD_SC_RESERVED,                                   // DC1
+    HID_KEYBOARD_SC_RESERVED,                                   // DC2
+    HID_KEYBOARD_SC_RESERVED,                                   // DC3
+    HID_KEYBOARD_SC_RESERVED,                                   // DC4
+    HID_KEYBOARD_SC_RESERVED,                                   // NAK
+    HID_KEYBOARD_SC_RESERVED,                                   // SYN
+    HID_KEYBOARD_SC_RESERVED,                                   // ETB
+    HID_KEYBOARD_SC_RESERVED,                                   // CAN
+    HID_KEYBOARD_SC_RESERVED,                                   // EM
+    HID_KEYBOARD_SC_RESERVED,                                   // SUB
+    HID_KEYBOARD_SC_RESERVED,                                   // ESC
+    HID_KEYBOARD_SC_RESERVED,                                   // FS
+    HID_KEYBOARD_SC_RESERVED,                                   // GS
+    HID_KEYBOARD_SC_RESERVED,                                   // RS
+    HID_KEYBOARD_SC_RESERVED,                                   // US
+
+    HID_KEYBOARD_SC_SPACE,                                      // ' ' Space
+    HID_KEYBOARD_SC_1_AND_EXCLAMATION|SHIFT,                    // !
+    HID_KEYBOARD_SC_2_AND_AT|SHIFT,                             // "
+    HID_KEYBOARD_SC_NON_US_HASHMARK_AND_TILDE,                  // #
+    HID_KEYBOARD_SC_4_AND_DOLLAR|SHIFT,                         // $
+    HID_KEYBOARD_SC_5_AND_PERCENTAGE|SHIFT,                     // %
+    HID_KEYBOARD_SC_6_AND_CARET|SHIFT,                          // &
+    HID_KEYBOARD_SC_NON_US_HASHMARK_AND_TILDE|SHIFT,            // '
+    HID_KEYBOARD_SC_8_AND_ASTERISK|SHIFT,                       // (
+    HID_KEYBOARD_SC_9_AND_OPENING_PARENTHESIS|SHIFT,            // )
+    HID_KEYBOARD_SC_CLOSING_BRACKET_AND_CLOSING_BRACE|SHIFT,    // *
+    HID_KEYBOARD_SC_CLOSING_BRACKET_AND_CLOSING_BRACE,          // +
+    HID_KEYBOARD_SC_COMMA_AND_LESS_THAN_SIGN,                   // ,
+    HID_KEYBOARD_SC_SLASH_AND_QUESTION_MARK,                    // -
+    HID_KEYBOARD_SC_DOT_AND_GREATER_THAN_SIGN,                  // .
+    HID_KEYBOARD_SC_7_AND_AMPERSAND|SHIFT,                      // /
+    HID_KEYBOARD_SC_0_AND_CLOSING_PARENTHESIS,                  // 0
+    HID_KEYBOARD_SC_1_AND_EXCLAMATION,                          // 1
+    HID_KEYBOARD_SC_2_AND_AT,                                   // 2
+    HID_KEYBOARD_SC_3_AND_HASHMARK,                             // 3
+    HID_KEYBOARD_SC_4_AND_DOLLAR,                               // 4
+    HID_KEYBOARD_SC_5_AND_PERCENTAGE,                           // 5
+    HID_KEYBOARD_SC_6_AND_CARET,                                // 6
+    HID_KEYBOARD_SC_7_AND_AMPERSAND,                            // 7
+    HID_KEYBOARD_SC_8_AND_ASTERISK,                             // 8
+    HID_KEYBOARD_SC_9_AND_OPENING_PARENTHESIS,                  // 9
+    HID_KEYBOARD_SC_DOT_AND_GREATER_THAN_SIGN|SHIFT,            // :
+    HID_KEYBOARD_SC_COMMA_AND_LESS_THAN_SIGN|SHIFT,             // ;
+    HID_KEYBOARD_SC_NON_US_BACKSLASH_AND_PIPE,                  // <
+    HID_KEYBOARD_SC_0_AND_CLOSING_PARENTHESIS|SHIFT,            // =
+    HID_KEYBOARD_SC_NON_US_BACKSLASH_AND_PIPE|SHIFT,            // >
+    HID_KEYBOARD_SC_MINUS_AND_UNDERSCORE|SHIFT,                 // ?
+    HID_KEYBOARD_SC_Q|ALTGR,                                    // @
+    HID_KEYBOARD_SC_A|SHIFT,                                    // A
+    HID_KEYBOARD_SC_B|SHIFT,                                    // B
+    HID_KEYBOARD_SC_C|SHIFT,                                    // C
+    HID_KEYBOARD_SC_D|SHIFT,                                    // D
+    HID_KEYBOARD_SC_E|SHIFT,                                    // E
+    HID_KEYBOARD_SC_F|SHIFT,                                    // F
+    HID_KEYBOARD_SC_G|SHIFT,                                    // G
+    HID_KEYBOARD_SC_H|SHIFT,                                    // H
+    HID_KEYBOARD_SC_I|SHIFT,                                    // I
+    HID_KEYBOARD_SC_J|SHIFT,                                    // J
+    HID_KEYBOARD_SC_K|SHIFT,                                    // K
+    HID_KEYBOARD_SC_L|SHIFT,                                    // L
+    HID_KEYBOARD_SC_M|SHIFT,                                    // M
+    HID_KEYBOARD_SC_N|SHIFT,                                    // N
+    HID_KEYBOARD_SC_O|SHIFT,                                    // O
+    HID_KEYBOARD_SC_P|SHIFT,                                    // P
+    HID_KEYBOARD_SC_Q|SHIFT,                                    // Q
+    HID_KEYBOARD_SC_R|SHIFT,                                    // R
+    HID_KEYBOARD_SC_S|SHIFT,                                    // S
+    HID_KEYBOARD_SC_T|SHIFT,                                    // T
+    HID_KEYBOARD_SC_U|SHIFT,                                    // U
+    HID_KEYBOARD_SC_V|SHIFT,                                    // V
+    HID_KEYBOARD_SC_W|SHIFT,                                    // W
+    HID_KEYBOARD_SC_X|SHIFT,                                    // X
+    HID_KEYBOARD_SC_Z|SHIFT,                                    // Y
+    HID_KEYBOARD_SC_Y|SHIFT,                                    // Z
+    HID_KEYBOARD_SC_8_AND_ASTERISK|ALTGR,                       // [
+    HID_KEYBOARD_SC_MINUS_AND_UNDERSCORE|ALTGR,                 // bslash
+    HID_KEYBOARD_SC_9_AND_OPENING_PARENTHESIS|ALTGR,            // ]
+    HID_KEYBOARD_SC_SPACE|DEAD_CIRCUMFLEX,                      // ^
+    HID_KEYBOARD_SC_SLASH_AND_QUESTION_MARK|SHIFT,              // _
+    HID_KEYBOARD_SC_SPACE|DEAD_GRAVE,                           // `
+    HID_KEYBOARD_SC_A,                                          // a
+    HID_KEYBOARD_SC_B,                                          // b
+    HID_KEYBOARD_SC_C,                                          // c
+    HID_KEYBOARD_SC_D,                                          // d
+    HID_KEYBOARD_SC_E,                                          // e
+    HID_KEYBOARD_SC_F,                                          // f
+    HID_KEYBOARD_SC_G,                                          // g
+    HID_KEYBOARD_SC_H,                                          // h
+    HID_KEYBOARD_SC_I,                                          // i
+    HID_KEYBOARD_SC_J,                                          // j
+    HID_KEYBOARD_SC_K,                                          // k
+    HID_KEYBOARD_SC_L,                                          // l
+    HID_KEYBOARD_SC_M,                                          // m
+    HID_KEYBOARD_SC_N,                                          // n
+    HID_KEYBOARD_SC_O,                                          // o
+    HID_KEYBOARD_SC_P,                                          // p
+    HID_KEYBOARD_SC_Q,                                          // q
+    HID_KEYBOARD_SC_R,                                          // r
+    HID_KEYBOARD_SC_S,                                          // s
+    HID_KEYBOARD_SC_T,                                          // t
+    HID_KEYBOARD_SC_U,                                          // u
+    HID_KEYBOARD_SC_V,                                          // v
+    HID_KEYBOARD_SC_W,                                          // w
+    HID_KEYBOARD_SC_X,                                          // x
+    HID_KEYBOARD_SC_Z,                                          // y
+    HID_KEYBOARD_SC_Y,                                          // z
+    HID_KEYBOARD_SC_7_AND_AMPERSAND|ALTGR,                      // {
+    HID_KEYBOARD_SC_NON_US_BACKSLASH_AND_PIPE|ALTGR,            // |
+    HID_KEYBOARD_SC_0_AND_CLOSING_PARENTHESIS|ALTGR,            // }
+    HID_KEYBOARD_SC_CLOSING_BRACKET_AND_CLOSING_BRACE|ALTGR,    // ~
+    HID_KEYBOARD_SC_RESERVED,                                   // DEL
+
+    HID_KEYBOARD_SC_RESERVED,                                   // U+0080
+    HID_KEYBOARD_SC_RESERVED,                                   // U+0081
+    HID_KEYBOARD_SC_RESERVED,                                   // U+0082
+    HID_KEYBOARD_SC_RESERVED,                                   // U+0083
+    HID_KEYBOARD_SC_RESERVED,                                   // U+0084
+    HID_KEYBOARD_SC_RESERVED,                                   // U+0085
+    HID_KEYBOARD_SC_RESERVED,                                   // U+0086
+    HID_KEYBOARD_SC_RESERVED,                                   // U+0087
+    HID_KEYBOARD_SC_RESERVED,                                   // U+0088
+    HID_KEYBOARD_SC_RESERVED,                                   // U+0089
+    HID_KEYBOARD_SC_RESERVED,                                   // U+008A
+    HID_KEYBOARD_SC_RESERVED,                                   // U+008B
+    HID_KEYBOARD_SC_RESERVED,                                   // U+008C
+    HID_KEYBOARD_SC_RESERVED,                                   // U+008D
+    HID_KEYBOARD_SC_RESERVED,                                   // U+008E
+    HID_KEYBOARD_SC_RESERVED,                                   // U+008F
+    HID_KEYBOARD_SC_RESERVED,                                   // U+0090
+    HID_KEYBOARD_SC_RESERVED,                                   // U+0091
+    HID_KEYBOARD_SC_RESERVED,                                   // U+0092
+    HID_KEYBOARD_SC_RESERVED,                                   // U+0093
+    HID_KEYBOARD_SC_RESERVED,                                   // U+0094
+    HID_KEYBOARD_SC_RESERVED,                                   // U+0095
+    HID_KEYBOARD_SC_RESERVED,                                   // U+0096
+    HID_KEYBOARD_SC_RESERVED,                                   // U+0097
+    HID_KEYBOARD_SC_RESERVED,                                   // U+0098
+    HID_KEYBOARD_SC_RESERVED,                                   // U+0099
+    HID_KEYBOARD_SC_RESERVED,                                   // U+009A
+    HID_KEYBOARD_SC_RESERVED,                                   // U+009B
+    HID_KEYBOARD_SC_RESERVED,                                   // U+009C
+    HID_KEYBOARD_SC_RESERVED,                                   // U+009D
+    HID_KEYBOARD_SC_RESERVED,                                   // U+009E
+    HID_KEYBOARD_SC_RESERVED,                                   // U+009F
+    HID_KEYBOARD_SC_RESERVED,                                   // U+00A0 NBSP
+    HID_KEYBOARD_SC_RESERVED,                                   // U+00A1 ¡
+    HID_KEYBOARD_SC_RESERVED,                                   // U+00A2 ¢
+    HID_KEYBOARD_SC_RESERVED,                                   // U+00A3 £
+    HID_KEYBOARD_SC_RESERVED,                                   // U+00A4 ¤
+    HID_KEYBOARD_SC_RESERVED,                                   // U+00A5 ¥
+    HID_KEYBOARD_SC_RESERVED,                                   // U+00A6 ¦
+    HID_KEYBOARD_SC_3_AND_HASHMARK|SHIFT,                       // U+00A7 §
+    HID_KEYBOARD_SC_RESERVED,                                   // U+00A8 ¨
+    HID_KEYBOARD_SC_RESERVED,                                   // U+00A9 ©
+    HID_KEYBOARD_SC_RESERVED,                                   // U+00AA ª
+    HID_KEYBOARD_SC_RESERVED,                                   // U+00AB «
+    HID_KEYBOARD_SC_RESERVED,                                   // U+00AC ¬
+    HID_KEYBOARD_SC_RESERVED,                                   // U+00AD SHY
+    HID_KEYBOARD_SC_RESERVED,                                   // U+00AE ®
+    HID_KEYBOARD_SC_RESERVED,                                   // U+00AF ¯
+    HID_KEYBOARD_SC_GRAVE_ACCENT_AND_TILDE|SHIFT,               // U+00B0 °
+    HID_KEYBOARD_SC_RESERVED,                                   // U+00B1 ±
+    HID_KEYBOARD_SC_2_AND_AT|ALTGR,                             // U+00B2 ²
+    HID_KEYBOARD_SC_3_AND_HASHMARK|ALTGR,                       // U+00B3 ³
+    HID_KEYBOARD_SC_SPACE|DEAD_ACUTE,                           // U+00B4 ´
+    HID_KEYBOARD_SC_M|ALTGR,                                    // U+00B5 µ
+    HID_KEYBOARD_SC_RESERVED,                                   // U+00B6 ¶
+    HID_KEYBOARD_SC_RESERVED,                                   // U+00B7 ·
+    HID_KEYBOARD_SC_RESERVED,                                   // U+00B8 ¸
+    HID_KEYBOARD_SC_RESERVED,                                   // U+00B9 ¹
+    HID_KEYBOARD_SC_RESERVED,                                   // U+00BA º
+    HID_KEYBOARD_SC_RESERVED,                                   // U+00BB »
+    HID_KEYBOARD_SC_RESERVED,                                   // U+00BC ¼
+    HID_KEYBOARD_SC_RESERVED,                                   // U+00BD ½
+    HID_KEYBOARD_SC_RESERVED,                                   // U+00BE ¾
+    HID_KEYBOARD_SC_RESERVED,                                   // U+00BF ¿
+    HID_KEYBOARD_SC_A|SHIFT|DEAD_GRAVE,                         // U+00C0 À
+    HID_KEYBOARD_SC_A|SHIFT|DEAD_ACUTE,                         // U+00C1 Á
+    HID_KEYBOARD_SC_A|SHIFT|DEAD_CIRCUMFLEX,                    // U+00C2 Â
+    HID_KEYBOARD_SC_RESERVED,                                   // U+00C3 Ã
+    HID_KEYBOARD_SC_APOSTROPHE_AND_QUOTE|SHIFT,                 // U+00C4 Ä
+    HID_KEYBOARD_SC_RESERVED,                                   // U+00C5 Å
+    HID_KEYBOARD_SC_RESERVED,                                   // U+00C6 Æ
+    HID_KEYBOARD_SC_RESERVED,                                   // U+00C7 Ç
+    HID_KEYBOARD_SC_E|SHIFT|DEAD_GRAVE,                         // U+00C8 È
+    HID_KEYBOARD_SC_E|SHIFT|DEAD_ACUTE,                         // U+00C9 É
+    HID_KEYBOARD_SC_E|SHIFT|DEAD_CIRCUMFLEX,                    // U+00CA Ê
+    HID_KEYBOARD_SC_RESERVED,                                   // U+00CB Ë
+    HID_KEYBOARD_SC_I|SHIFT|DEAD_GRAVE,                         // U+00CC Ì
+    HID_KEYBOARD_SC_I|SHIFT|DEAD_ACUTE,                         // U+00CD Í
+    HID_KEYBOARD_SC_I|SHIFT|DEAD_CIRCUMFLEX,                    // U+00CE Î
+    HID_KEYBOARD_SC_RESERVED,                                   // U+00CF Ï
+    HID_KEYBOARD_SC_RESERVED,                                   // U+00D0 Ð
+    HID_KEYBOARD_SC_RESERVED,                                   // U+00D1 Ñ
+    HID_KEYBOARD_SC_O|SHIFT|DEAD_GRAVE,                         // U+00D2 Ò
+    HID_KEYBOARD_SC_O|SHIFT|DEAD_ACUTE,                         // U+00D3 Ó
+    HID_KEYBOARD_SC_O|SHIFT|DEAD_CIRCUMFLEX,                    // U+00D4 Ô
+    HID_KEYBOARD_SC_RESERVED,                                   // U+00D5 Õ
+    HID_KEYBOARD_SC_SEMICOLON_AND_COLON|SHIFT,                  // U+00D6 Ö
+    HID_KEYBOARD_SC_RESERVED,                                   // U+00D7 ×
+    HID_KEYBOARD_SC_RESERVED,                                   // U+00D8 Ø
+    HID_KEYBOARD_SC_U|SHIFT|DEAD_GRAVE,                         // U+00D9 Ù
+    HID_KEYBOARD_SC_U|SHIFT|DEAD_ACUTE,                         // U+00DA Ú
+    HID_KEYBOARD_SC_U|SHIFT|DEAD_CIRCUMFLEX,                    // U+00DB Û
+    HID_KEYBOARD_SC_OPENING_BRACKET_AND_OPENING_BRACE|SHIFT,    // U+00DC Ü
+    HID_KEYBOARD_SC_Z|SHIFT|DEAD_ACUTE,                         // U+00DD Ý
+    HID_KEYBOARD_SC_RESERVED,                                   // U+00DE Þ
+    HID_KEYBOARD_SC_MINUS_AND_UNDERSCORE,                       // U+00DF ß
+    HID_KEYBOARD_SC_A|DEAD_GRAVE,                               // U+00E0 à
+    HID_KEYBOARD_SC_A|DEAD_ACUTE,                               // U+00E1 á
+    HID_KEYBOARD_SC_A|DEAD_CIRCUMFLEX,                          // U+00E2 â
+    HID_KEYBOARD_SC_RESERVED,                                   // U+00E3 ã
+    HID_KEYBOARD_SC_APOSTROPHE_AND_QUOTE,                       // U+00E4 ä
+    HID_KEYBOARD_SC_RESERVED,                                   // U+00E5 å
+    HID_KEYBOARD_SC_RESERVED,                                   // U+00E6 æ
+    HID_KEYBOARD_SC_RESERVED,                                   // U+00E7 ç
+    HID_KEYBOARD_SC_E|DEAD_GRAVE,                               // U+00E8 è
+    HID_KEYBOARD_SC_E|DEAD_ACUTE,                               // U+00E9 é
+    HID_KEYBOARD_SC_E|DEAD_CIRCUMFLEX,                          // U+00EA ê
+    HID_KEYBOARD_SC_RESERVED,                                   // U+00EB ë
+    HID_KEYBOARD_SC_I|DEAD_GRAVE,                               // U+00EC ì
+    HID_KEYBOARD_SC_I|DEAD_ACUTE,                               // U+00ED í
+    HID_KEYBOARD_SC_I|DEAD_CIRCUMFLEX,                          // U+00EE î
+    HID_KEYBOARD_SC_RESERVED,                                   // U+00EF ï
+    HID_KEYBOARD_SC_RESERVED,                                   // U+00F0 ð
+    HID_KEYBOARD_SC_RESERVED,                                   // U+00F1 ñ
+    HID_KEYBOARD_SC_O|DEAD_GRAVE,                               // U+00F2 ò
+    HID_KEYBOARD_SC_O|DEAD_ACUTE,                               // U+00F3 ó
+    HID_KEYBOARD_SC_O|DEAD_CIRCUMFLEX,                          // U+00F4 ô
+    HID_KEYBOARD_SC_RESERVED,                                   // U+00F5 õ
+    HID_KEYBOARD_SC_SEMICOLON_AND_COLON,                        // U+00F6 ö
+    HID_KEYBOARD_SC_RESERVED,                                   // U+00F7 ÷
+    HID_KEYBOARD_SC_RESERVED,                                   // U+00F8 ø
+    HID_KEYBOARD_SC_U|DEAD_GRAVE,                               // U+00F9 ù
+    HID_KEYBOARD_SC_U|DEAD_ACUTE,                               // U+00FA ú
+    HID_KEYBOARD_SC_U|DEAD_CIRCUMFLEX,                          // U+00FB û
+    HID_KEYBOARD_SC_OPENING_BRACKET_AND_OPENING_BRACE,          // U+00FC ü
+    HID_KEYBOARD_SC_Z|DEAD_ACUTE,                               // U+00FD ý
+    HID_KEYBOARD_SC_RESERVED,                                   // U+00FE þ
+    HID_KEYBOARD_SC_RESERVED                                    // U+00FF ÿ
+};
+
+static const uint16_t USB_keyboardDeadKeysDe[] PROGMEM =
+{
+    HID_KEYBOARD_SC_GRAVE_ACCENT_AND_TILDE,                     // Circumflex
+    HID_KEYBOARD_SC_EQUAL_AND_PLUS,                             // Acute
+    HID_KEYBOARD_SC_EQUAL_AND_PLUS|SHIFT,                       // Grave
+    HID_KEYBOARD_SC_RESERVED,                                   // Diaeresis
+    HID_KEYBOARD_SC_RESERVED                                    // Tilde
+};
+
+#define USB_KEYBOARD_EURO (HID_KEYBOARD_SC_E|ALTGR)
+
+#elif defined(USB_KEYBOARD_LAYOUT_FR)
+// French AZERTY layout, Latin-1
+static const uint16_t USB_keyboardAsciiMapFr[] PROGMEM =
+{
+    HID_KEYBOARD_SC_RESERVED,                                   // NUL
+    HID_KEYBOARD_SC_RESERVED,                                   // SOH
+    HID_KEYBOARD_SC_RESERVED,                                   // STX
+    HID_KEYBOARD_SC_RESERVED,                                   // ETX
+    HID_KEYBOARD_SC_RESERVED,                                   // EOT
+    HID_KEYBOARD_SC_RESERVED,                                   // ENQ
+    HID_KEYBOARD_SC_RESERVED,                                   // ACK
+    HID_KEYBOARD_SC_RESERVED,                                   // BEL
+    HID_KEYBOARD_SC_BACKSPACE,                                  // BS Backspace
+    HID_KEYBOARD_SC_TAB,                                        // TAB    Tab
+    HID_KEYBOARD_SC_ENTER,                                      // LF Enter
+    HID_KEYBOARD_SC_RESERVED,                                   // VT
+    HID_KEYBOARD_SC_RESERVED,                                   // FF
+    HID_KEYBOARD_SC_RESERVED,                                   // CR
+    HID_KEYBOARD_SC_RESERVED,                                   // SO
+    HID_KEYBOARD_SC_RESERVED,                                   // SI
+    HID_KEYBOARD_SC_RESERVED,                                   // DEL
+    HID_KEYBOARD_SC_RESERVED,                                   // DC1
+    HID_KEYBOARD_SC_RESERVED,                                   // DC2
+    HID_KEYBOARD_SC_RESERVED,                                   // DC3
+    HID_KEYBOARD_SC_RESERVED,                                   // DC4
+    HID_KEYBOARD_SC_RESERVED,                                   // NAK
+    HID_KEYBOARD_SC_RESERVED,                                   // SYN
+    HID_KEYBOARD_SC_RESERVED,                                   // ETB
+    HID_KEYBOARD_SC_RESERVED,                                   // CAN
+    HID_KEYBOARD_SC_RESERVED,                                   // EM
+    HID_KEYBOARD_SC_RESERVED,                                   // SUB
+    HID_KEYBOARD_SC_RESERVED,                                   // ESC
+    HID_KEYBOARD_SC_RESERVED,                                   // FS
+    HID_KEYBOARD_SC_RESERVED,                                   // GS
+    HID_KEYBOARD_SC_RESERVED,                                   // RS
+    HID_KEYBOARD_SC_RESERVED,                                   // US
+
+    HID_KEYBOARD_SC_SPACE,                                      // ' ' Space
+    HID_KEYBOARD_SC_SLASH_AND_QUESTION_MARK,                    // !
+    HID_KEYBOARD_SC_3_AND_HASHMARK,                             // "
+    HID_KEYBOARD_SC_3_AND_HASHMARK|ALTGR,                       // #
+    HID_KEYBOARD_SC_CLOSING_BRACKET_AND_CLOSING_BRACE,          // $
+    HID_KEYBOARD_SC_APOSTROPHE_AND_QUOTE|SHIFT,                 // %
+    HID_KEYBOARD_SC_1_AND_EXCLAMATION,                          // &
+    HID_KEYBOARD_SC_4_AND_DOLLAR,                               // '
+    HID_KEYBOARD_SC_5_AND_PERCENTAGE,                           // (
+    HID_KEYBOARD_SC_MINUS_AND_UNDERSCORE,                       // )
+    HID_KEYBOARD_SC_NON_US_HASHMARK_AND_TILDE,                  // *
+    HID_KEYBOARD_SC_EQUAL_AND_PLUS|SHIFT,                       // +
+    HID_KEYBOARD_SC_M,                                          // ,
+    HID_KEYBOARD_SC_6_AND_CARET,                                // -
+    HID_KEYBOARD_SC_COMMA_AND_LESS_THAN_SIGN|SHIFT,             // .
+    HID_KEYBOARD_SC_DOT_AND_GREATER_THAN_SIGN|SHIFT,            // /
+    HID_KEYBOARD_SC_0_AND_CLOSING_PARENTHESIS|SHIFT,            // 0
+    HID_KEYBOARD_SC_1_AND_EXCLAMATION|SHIFT,                    // 1
+    HID_KEYBOARD_SC_2_AND_AT|SHIFT,                             // 2
+    HID_KEYBOARD_SC_3_AND_HASHMARK|SHIFT,                       // 3
+    HID_KEYBOARD_SC_4_AND_DOLLAR|SHIFT,                         // 4
+    HID_KEYBOARD_SC_5_AND_PERCENTAGE|SHIFT,                     // 5
+    HID_KEYBOARD_SC_6_AND_CARET|SHIFT,                          // 6
+    HID_KEYBOARD_SC_7_AND_AMPERSAND|SHIFT,                      // 7
+    HID_KEYBOARD_SC_8_AND_ASTERISK|SHIFT,                       // 8
+    HID_KEYBOARD_SC_9_AND_OPENING_PARENTHESIS|SHIFT,            // 9
+    HID_KEYBOARD_SC_DOT_AND_GREATER_THAN_SIGN,                  // :
+    HID_KEYBOARD_SC_COMMA_AND_LESS_THAN_SIGN,                   // ;
+    HID_KEYBOARD_SC_NON_US_BACKSLASH_AND_PIPE,                  // <
+    HID_KEYBOARD_SC_EQUAL_AND_PLUS,                             // =
+    HID_KEYBOARD_SC_NON_US_BACKSLASH_AND_PIPE|SHIFT,            // >
+    HID_KEYBOARD_SC_M|SHIFT,                                    // ?
+    HID_KEYBOARD_SC_0_AND_CLOSING_PARENTHESIS|ALTGR,            // @
+    HID_KEYBOARD_SC_Q|SHIFT,                                    // A
+    HID_KEYBOARD_SC_B|SHIFT,                                    // B
+    HID_KEYBOARD_SC_C|SHIFT,                                    // C
+    HID_KEYBOARD_SC_D|SHIFT,                                    // D
+    HID_KEYBOARD_SC_E|SHIFT,                                    // E
+    HID_KEYBOARD_SC_F|SHIFT,                                    // F
+    HID_KEYBOARD_SC_G|SHIFT,                                    // G
+    HID_KEYBOARD_SC_H|SHIFT,                                    // H
+    HID_KEYBOARD_SC_I|SHIFT,                                    // I
+    HID_KEYBOARD_SC_J|SHIFT,                                    // J
+    HID_KEYBOARD_SC_K|SHIFT,                                    // K
+    HID_KEYBOARD_SC_L|SHIFT,                                    // L
+    HID_KEYBOARD_SC_SEMICOLON_AND_COLON|SHIFT,                  // M
+    HID_KEYBOARD_SC_N|SHIFT,                                    // N
+    HID_KEYBOARD_SC_O|SHIFT,                                    // O
+    HID_KEYBOARD_SC_P|SHIFT,                                    // P
+    HID_KEYBOARD_SC_A|SHIFT,                                    // Q
+    HID_KEYBOARD_SC_R|SHIFT,                                    // R
+    HID_KEYBOARD_SC_S|SHIFT,                                    // S
+    HID_KEYBOARD_SC_T|SHIFT,                                    // T
+    HID_KEYBOARD_SC_U|SHIFT,                                    // U
+    HID_KEYBOARD_SC_V|SHIFT,                                    // V
+    HID_KEYBOARD_SC_Z|SHIFT,                                    // W
+    HID_KEYBOARD_SC_X|SHIFT,                                    // X
+    HID_KEYBOARD_SC_Y|SHIFT,                                    // Y
+    HID_KEYBOARD_SC_W|SHIFT,                                    // Z
+    HID_KEYBOARD_SC_5_AND_PERCENTAGE|ALTGR,                     // [
+    HID_KEYBOARD_SC_8_AND_ASTERISK|ALTGR,                       // bslash
+    HID_KEYBOARD_SC_MINUS_AND_UNDERSCORE|ALTGR,                 // ]
+    HID_KEYBOARD_SC_9_AND_OPENING_PARENTHESIS|ALTGR,            // ^
+    HID_KEYBOARD_SC_8_AND_ASTERISK,                             // _
+    HID_KEYBOARD_SC_SPACE|DEAD_GRAVE,                           // `
+    HID_KEYBOARD_SC_Q,                                          // a
+    HID_KEYBOARD_SC_B,                                          // b
+    HID_KEYBOARD_SC_C,                                          // c
+    HID_KEYBOARD_SC_D,                                          // d
+    HID_KEYBOARD_SC_E,                                          // e
+    HID_KEYBOARD_SC_F,                                          // f
+    HID_KEYBOARD_SC_G,                                          // g
+    HID_KEYBOARD_SC_H,                                          // h
+    HID_KEYBOARD_SC_I,                                          // i
+    HID_KEYBOARD_SC_J,                                          // j
+    HID_KEYBOARD_SC_K,                                          // k
+    HID_KEYBOARD_SC_L,                                          // l
+    HID_KEYBOARD_SC_SEMICOLON_AND_COLON,                        // m
+    HID_KEYBOARD_SC_N,                                          // n
+    HID_KEYBOARD_SC_O,                                          // o
+    HID_KEYBOARD_SC_P,                                          // p
+    HID_KEYBOARD_SC_A,                                          // q
+    HID_KEYBOARD_SC_R,                                          // r
+    HID_KEYBOARD_SC_S,                                          // s
+    HID_KEYBOARD_SC_T,                                          // t
+    HID_KEYBOARD_SC_U,                                          // u
+    HID_KEYBOARD_SC_V,                                          // v
+    HID_KEYBOARD_SC_Z,                                          // w
+    HID_KEYBOARD_SC_X,                                          // x
+    HID_KEYBOARD_SC_Y,                                          // y
+    HID_KEYBOARD_SC_W,                                          // z
+    HID_KEYBOARD_SC_4_AND_DOLLAR|ALTGR,                         // {
+    HID_KEYBOARD_SC_6_AND_CARET|ALTGR,                          // |
+    HID_KEYBOARD_SC_EQUAL_AND_PLUS|ALTGR,                       // }
+    HID_KEYBOARD_SC_SPACE|DEAD_TILDE,                           // ~
+    HID_KEYBOARD_SC_RESERVED,                                   // DEL
+
+    HID_KEYBOARD_SC_RESERVED,                                   // U+0080
+    HID_KEYBOARD_SC_RESERVED,                                   // U+0081
+    HID_KEYBOARD_SC_RESERVED,                                   // U+0082
+    HID_KEYBOARD_SC_RESERVED,                                   // U+0083
+    HID_KEYBOARD_SC_RESERVED,                                   // U+0084
+    HID_KEYBOARD_SC_RESERVED,                                   // U+0085
+    HID_KEYBOARD_SC_RESERVED,                                   // U+0086
+    HID_KEYBOARD_SC_RESERVED,                                   // U+0087
+    HID_KEYBOARD_SC_RESERVED,                                   // U+0088
+    HID_KEYBOARD_SC_RESERVED,                                   // U+0089
+    HID_KEYBOARD_SC_RESERVED,                                   // U+008A
+    HID_KEYBOARD_SC_RESERVED,                                   // U+008B
+    HID_KEYBOARD_SC_RESERVED,                                   // U+008C
+    HID_KEYBOARD_SC_RESERVED,                                   // U+008D
+    HID_KEYBOARD_SC_RESERVED,                                   // U+008E
+    HID_KEYBOARD_SC_RESERVED,                                   // U+008F
+    HID_KEYBOARD_SC_RESERVED,                                   // U+0090
+    HID_KEYBOARD_SC_RESERVED,                                   // U+0091
+    HID_KEYBOARD_SC_RESERVED,                                   // U+0092
+    HID_KEYBOARD_SC_RESERVED,                                   // U+0093
+    HID_KEYBOARD_SC_RESERVED,                                   // U+0094
+    HID_KEYBOARD_SC_RESERVED,                                   // U+0095
+    HID_KEYBOARD_SC_RESERVED,                                   // U+0096
+    HID_KEYBOARD_SC_RESERVED,                                   // U+0097
+    HID_KEYBOARD_SC_RESERVED,                                   // U+0098
+    HID_KEYBOARD_SC_RESERVED,                                   // U+0099
+    HID_KEYBOARD_SC_RESERVED,                                   // U+009A
+    HID_KEYBOARD_SC_RESERVED,                                   // U+009B
+    HID_KEYBOARD_SC_RESERVED,                                   // U+009C
+    HID_KEYBOARD_SC_RESERVED,                                   // U+009D
+    HID_KEYBOARD_SC_RESERVED,                                   // U+009E
+    HID_KEYBOARD_SC_RESERVED,                                   // U+009F
+    HID_KEYBOARD_SC_RESERVED,                                   // U+00A0 NBSP
+    HID_KEYBOARD_SC_RESERVED,                                   // U+00A1 ¡
+    HID_KEYBOARD_SC_RESERVED,                                   // U+00A2 ¢
+    HID_KEYBOARD_SC_CLOSING_BRACKET_AND_CLOSING_BRACE|SHIFT,    // U+00A3 £
+    HID_KEYBOARD_SC_CLOSING_BRACKET_AND_CLOSING_BRACE|ALTGR,    // U+00A4 ¤
+    HID_KEYBOARD_SC_RESERVED,                                   // U+00A5 ¥
+    HID_KEYBOARD_SC_RESERVED,                                   // U+00A6 ¦
+    HID_KEYBOARD_SC_SLASH_AND_QUESTION_MARK|SHIFT,              // U+00A7 §
+    HID_KEYBOARD_SC_SPACE|DEAD_DIAERESIS,                       // U+00A8 ¨
+    HID_KEYBOARD_SC_RESERVED,                                   // U+00A9 ©
+    HID_KEYBOARD_SC_RESERVED,                                   // U+00AA ª
+    HID_KEYBOARD_SC_RESERVED,                                   // U+00AB «
+    HID_KEYBOARD_SC_RESERVED,                                   // U+00AC ¬
+    HID_KEYBOARD_SC_RESERVED,                                   // U+00AD SHY
+    HID_KEYBOARD_SC_RESERVED,                                   // U+00AE ®
+    HID_KEYBOARD_SC_RESERVED,                                   // U+00AF ¯
+    HID_KEYBOARD_SC_MINUS_AND_UNDERSCORE|SHIFT,                 // U+00B0 °
+    HID_KEYBOARD_SC_RESERVED,                                   // U+00B1 ±
+    HID_KEYBOARD_SC_GRAVE_ACCENT_AND_TILDE,                     // U+00B2 ²
+    HID_KEYBOARD_SC_RESERVED,                                   // U+00B3 ³
+    HID_KEYBOARD_SC_RESERVED,                                   // U+00B4 ´
+    HID_KEYBOARD_SC_NON_US_HASHMARK_AND_TILDE|SHIFT,            // U+00B5 µ
+    HID_KEYBOARD_SC_RESERVED,                                   // U+00B6 ¶
+    HID_KEYBOARD_SC_RESERVED,                                   // U+00B7 ·
+    HID_KEYBOARD_SC_RESERVED,                                   // U+00B8 ¸
+    HID_KEYBOARD_SC_RESERVED,                                   // U+00B9 ¹
+    HID_KEYBOARD_SC_RESERVED,                                   // U+00BA º
+    HID_KEYBOARD_SC_RESERVED,                                   // U+00BB »
+    HID_KEYBOARD_SC_RESERVED,                                   // U+00BC ¼
+    HID_KEYBOARD_SC_RESERVED,                                   // U+00BD ½
+    HID_KEYBOARD_SC_RESERVED,                                   // U+00BE ¾
+    HID_KEYBOARD_SC_RESERVED,                                   // U+00BF ¿
+    HID_KEYBOARD_SC_Q|SHIFT|DEAD_GRAVE,                         // U+00C0 À
+    HID_KEYBOARD_SC_RESERVED,                                   // U+00C1 Á
+    HID_KEYBOARD_SC_Q|SHIFT|DEAD_CIRCUMFLEX,                    // U+00C2 Â
+    HID_KEYBOARD_SC_Q|SHIFT|DEAD_TILDE,                         // U+00C3 Ã
+    HID_KEYBOARD_SC_Q|SHIFT|DEAD_DIAERESIS,                     // U+00C4 Ä
+    HID_KEYBOARD_SC_RESERVED,                                   // U+00C5 Å
+    HID_KEYBOARD_SC_RESERVED,                                   // U+00C6 Æ
+    HID_KEYBOARD_SC_RESERVED,                                   // U+00C7 Ç
+    HID_KEYBOARD_SC_E|SHIFT|DEAD_GRAVE,                         // U+00C8 È
+    HID_KEYBOARD_SC_RESERVED,                                   // U+00C9 É
+    HID_KEYBOARD_SC_E|SHIFT|DEAD_CIRCUMFLEX,                    // U+00CA Ê
+    HID_KEYBOARD_SC_E|SHIFT|DEAD_DIAERESIS,                     // U+00CB Ë
+    HID_KEYBOARD_SC_I|SHIFT|DEAD_GRAVE,                         // U+00CC Ì
+    HID_KEYBOARD_SC_RESERVED,                                   // U+00CD Í
+    HID_KEYBOARD_SC_I|SHIFT|DEAD_CIRCUMFLEX,                    // U+00CE Î
+    HID_KEYBOARD_SC_I|SHIFT|DEAD_DIAERESIS,                     // U+00CF Ï
+    HID_KEYBOARD_SC_RESERVED,                                   // U+00D0 Ð
+    HID_KEYBOARD_SC_N|SHIFT|DEAD_TILDE,                         // U+00D1 Ñ
+    HID_KEYBOARD_SC_O|SHIFT|DEAD_GRAVE,                         // U+00D2 Ò
+    HID_KEYBOARD_SC_RESERVED,                                   // U+00D3 Ó
+    HID_KEYBOARD_SC_O|SHIFT|DEAD_CIRCUMFLEX,                    // U+00D4 Ô
+    HID_KEYBOARD_SC_O|SHIFT|DEAD_TILDE,                         // U+00D5 Õ
+    HID_KEYBOARD_SC_O|SHIFT|DEAD_DIAERESIS,                     // U+00D6 Ö
+    HID_KEYBOARD_SC_RESERVED,                                   // U+00D7 ×
+    HID_KEYBOARD_SC_RESERVED,                                   // U+00D8 Ø
+    HID_KEYBOARD_SC_U|SHIFT|DEAD_GRAVE,                         // U+00D9 Ù
+    HID_KEYBOARD_SC_RESERVED,                                   // U+00DA Ú
+    HID_KEYBOARD_SC_U|SHIFT|DEAD_CIRCUMFLEX,                    // U+00DB Û
+    HID_KEYBOARD_SC_U|SHIFT|DEAD_DIAERESIS,                     // U+00DC Ü
+    HID_KEYBOARD_SC_RESERVED,                                   // U+00DD Ý
+    HID_KEYBOARD_SC_RESERVED,                                   // U+00DE Þ
+    HID_KEYBOARD_SC_RESERVED,                                   // U+00DF ß
+    HID_KEYBOARD_SC_0_AND_CLOSING_PARENTHESIS,                  // U+00E0 à
+    HID_KEYBOARD_SC_RESERVED,                                   // U+00E1 á
+    HID_KEYBOARD_SC_Q|DEAD_CIRCUMFLEX,                          // U+00E2 â
+    HID_KEYBOARD_SC_Q|DEAD_TILDE,                               // U+00E3 ã
+    HID_KEYBOARD_SC_Q|DEAD_DIAERESIS,                           // U+00E4 ä
+    HID_KEYBOARD_SC_RESERVED,                                   // U+00E5 å
+    HID_KEYBOARD_SC_RESERVED,                                   // U+00E6 æ
+    HID_KEYBOARD_SC_9_AND_OPENING_PARENTHESIS,                  // U+00E7 ç
+    HID_KEYBOARD_SC_7_AND_AMPERSAND,                            // U+00E8 è
+    HID_KEYBOARD_SC_2_AND_AT,                                   // U+00E9 é
+    HID_KEYBOARD_SC_E|DEAD_CIRCUMFLEX,                          // U+00EA ê
+    HID_KEYBOARD_SC_E|DEAD_DIAERESIS,                           // U+00EB ë
+    HID_KEYBOARD_SC_I|DEAD_GRAVE,                               // U+00EC ì
+    HID_KEYBOARD_SC_RESERVED,                                   // U+00ED í
+    HID_KEYBOARD_SC_I|DEAD_CIRCUMFLEX,                          // U+00EE î
+    HID_KEYBOARD_SC_I|DEAD_DIAERESIS,                           // U+00EF ï
+    HID_KEYBOARD_SC_RESERVED,                                   // U+00F0 ð
+    HID_KEYBOARD_SC_N|DEAD_TILDE,                               // U+00F1 ñ
+    HID_KEYBOARD_SC_O|DEAD_GRAVE,                               // U+00F2 ò
+    HID_KEYBOARD_SC_RESERVED,                                   // U+00F3 ó
+    HID_KEYBOARD_SC_O|DEAD_CIRCUMFLEX,                          // U+00F4 ô
+    HID_KEYBOARD_SC_O|DEAD_TILDE,                               // U+00F5 õ
+    HID_KEYBOARD_SC_O|DEAD_DIAERESIS,                           // U+00F6 ö
+    HID_KEYBOARD_SC_RESERVED,                                   // U+00F7 ÷
+    HID_KEYBOARD_SC_RESERVED,                                   // U+00F8 ø
+    HID_KEYBOARD_SC_APOSTROPHE_AND_QUOTE,                       // U+00F9 ù
+    HID_KEYBOARD_SC_RESERVED,                                   // U+00FA ú
+    HID_KEYBOARD_SC_U|DEAD_CIRCUMFLEX,                          // U+00FB û
+    HID_KEYBOARD_SC_U|DEAD_DIAERESIS,                           // U+00FC ü
+    HID_KEYBOARD_SC_RESERVED,                                   // U+00FD ý
+    HID_KEYBOARD_SC_RESERVED,                                   // U+00FE þ
+    HID_KEYBOARD_SC_Y|DEAD_DIAERESIS                            // U+00FF ÿ
+};
+
+static const uint16_t USB_keyboardDeadKeysFr[] PROGMEM =
+{
+    HID_KEYBOARD_SC_OPENING_BRACKET_AND_OPENING_BRACE,          // Circumflex
+    HID_KEYBOARD_SC_RESERVED,                                   // Acute
+    HID_KEYBOARD_SC_7_AND_AMPERSAND|ALTGR,                      // Grave
+    HID_KEYBOARD_SC_OPENING_BRACKET_AND_OPENING_BRACE|SHIFT,    // Diaeresis
+    HID_KEYBOARD_SC_2_AND_AT|ALTGR                              // Tilde
+};
+
+#define USB_KEYBOARD_EURO (HID_KEYBOARD_SC_E|ALTGR)
+#endif
@@ -0,0 +1,129 @@
+/*
+Copyright (c) 2018 NicoHood
+See the readme for credit to other people.
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+THE SOFTWARE.
+*/
+
+// USB MIDI event rate and latency benchmark.
+// USB can't be simulated, so this runs on real hardware and is controlled by
+// the host tool in ../../host (usb_midi_bench -d /dev/snd/midiC1D0).
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <avr/interrupt.h>
+#include "usb.h"
+#include "usb_midi.h"
+#include "usb_midi_bench.h"
+
+// Events moved per loop iteration, one USB packet
+#define CHUNK (MIDI_STREAM_EPSIZE / sizeof(MIDI_EventPacket_t))
+
+static MIDI_EventPacket_t pattern_event(uint16_t i)
+{
+    return usb_midi_event(0, USB_MIDI_BENCH_STATUS, USB_MIDI_BENCH_DATA1(i), USB_MIDI_BENCH_DATA2(i));
+}
+
+static void send_end(uint8_t cmd, uint8_t value)
+{
+    MIDI_EventPacket_t end = usb_midi_event(0, USB_MIDI_BENCH_CMD_STATUS, cmd, value);
+    while (usb_midi_connected() && !usb_midi_write(&end, 1)) {
+        usb_task();
+    }
+}
+
+// Device sends the pattern as fast as the host takes it
+static void bench_in(uint32_t count)
+{
+    uint32_t pos = 0;
+    while (pos < count && usb_midi_connected()) {
+        usb_task();
+        MIDI_EventPacket_t events[CHUNK];
+        uint8_t len = usb_midi_avail_write();
+        if (len > CHUNK) {
+            len = CHUNK;
+        }
+        if (len > count - pos) {
+            len = count - pos;
+        }
+        for (uint8_t i = 0; i < len; i++) {
+            events[i] = pattern_event(pos + i);
+        }
+        pos += usb_midi_write(events, len);
+    }
+    send_end(USB_MIDI_BENCH_CMD_IN, 0);
+}
+
+// Device receives and checks the pattern
+static void bench_out(uint32_t count)
+{
+    uint32_t pos = 0;
+    bool errors = false;
+    while (pos < count && usb_midi_connected()) {
+        usb_task();
+        MIDI_EventPacket_t events[CHUNK];
+        uint8_t len = usb_midi_read(events, CHUNK);
+        for (uint8_t i = 0; i < len; i++) {
+            MIDI_EventPacket_t expected = pattern_event(pos + i);
+            if (events[i].Event != expected.Event || events[i].Data1 != expected.Data1
+                || events[i].Data2 != expected.Data2 || events[i].Data3 != expected.Data3) {
+                errors = true;
+            }
+        }
+        pos += len;
+    }
+    send_end(USB_MIDI_BENCH_CMD_OUT, errors);
+}
+
+int main(void)
+{
+    // Initialize libraries
+    USB_Init();
+
+    // Enable interrupts
+    sei();
+
+    while (true)
+    {
+        usb_task();
+
+        // Echo everything except commands, only take what can be sent back
+        MIDI_EventPacket_t events[CHUNK];
+        uint8_t len = usb_midi_avail_write();
+        if (len > CHUNK) {
+            len = CHUNK;
+        }
+        len = usb_midi_read(events, len);
+        for (uint8_t i = 0; i < len; i++) {
+            MIDI_EventPacket_t* event = &events[i];
+            if (event->Data1 == USB_MIDI_BENCH_CMD_STATUS && event->Data3) {
+                uint32_t count = (uint32_t)event->Data3 * USB_MIDI_BENCH_UNIT;
+                if (event->Data2 == USB_MIDI_BENCH_CMD_IN) {
+                    bench_in(count);
+                    continue;
+                }
+                if (event->Data2 == USB_MIDI_BENCH_CMD_OUT) {
+                    bench_out(count);
+                    continue;
+                }
+            }
+            usb_midi_write(event, 1);
+        }
+    }
+}
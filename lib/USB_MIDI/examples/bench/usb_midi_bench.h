@@ -0,0 +1,53 @@
+/*
+Copyright (c) 2018 NicoHood
+See the readme for credit to other people.
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+THE SOFTWARE.
+*/
+
+// Protocol between the USB MIDI benchmark firmware and its host tool.
+// Shared by both sides, so it must stay plain C without AVR headers.
+// Everything is sent as 3 byte channel voice messages, so the host can use
+// any MIDI API (or the raw /dev/snd/midi* device) without extra drivers.
+
+// Include guard
+#pragma once
+
+// Commands are control changes on channel 16 with the count in 256 events:
+// control change, command controller, count / 256 (1-127).
+// The device ends every command with the same control change and value 0.
+#define USB_MIDI_BENCH_CMD_STATUS  0xBF
+
+// Device sends <count> pattern events (IN rate)
+#define USB_MIDI_BENCH_CMD_IN      0x7F
+
+// Device receives and checks <count> pattern events (OUT rate).
+// The end message has the value 1 instead of 0 if any event was wrong.
+#define USB_MIDI_BENCH_CMD_OUT     0x7E
+
+// Count unit of the commands
+#define USB_MIDI_BENCH_UNIT        256
+
+// All other messages are echoed (round trip latency and echo rate).
+
+// Pattern event number i: note on, channel 1, note and velocity count up.
+// It repeats every 16384 events.
+#define USB_MIDI_BENCH_STATUS      0x90
+#define USB_MIDI_BENCH_DATA1(i)    ((uint8_t)((i) & 0x7F))
+#define USB_MIDI_BENCH_DATA2(i)    ((uint8_t)(((i) >> 7) & 0x7F))
@@ -0,0 +1,386 @@
+/*
+Copyright (c) 2018 NicoHood
+See the readme for credit to other people.
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+THE SOFTWARE.
+*/
+
+// Host side of the USB MIDI benchmark (examples/bench).
+// Measures the event rate in each direction, the echo rate with several
+// events in flight and the round trip latency of single events.
+// Events are 3 byte MIDI messages on the raw MIDI device of the kernel,
+// which packs them into 4 byte USB-MIDI event packets.
+//
+// Usage: usb_midi_bench -d /dev/snd/midiC1D0 [-n units] [-r repetitions] [-w window]
+//        usb_midi_bench -l [-n units] [-r repetitions] [-w window]
+// -n sets the IN/OUT test size in 256 events (1-127), default 64.
+// -w sets the number of events in flight for the echo rate, default 32.
+// -l runs against a local stand-in device on a socket pair instead of hardware,
+//    which tests the protocol without a device (make check).
+//    Its numbers only describe the sockets, not the USB MIDI library.
+// Returns 1 if any event was wrong or missing.
+
+#define _DEFAULT_SOURCE
+#include <stdint.h>
+#include <stdbool.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <poll.h>
+#include <signal.h>
+#include <time.h>
+#include <unistd.h>
+#include <sys/socket.h>
+#include <sys/wait.h>
+#include "../examples/bench/usb_midi_bench.h"
+
+// Give up if the device does not answer for this time
+#define TIMEOUT_MS 3000
+
+// Size of the channel voice messages used by the protocol
+#define MESSAGE_SIZE 3
+
+// Messages per write, the size of a USB packet
+#define CHUNK 16
+
+static double now_ms(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec * 1e3 + ts.tv_nsec / 1e6;
+}
+
+static int write_all(int fd, const uint8_t* buff, size_t len)
+{
+    while (len) {
+        ssize_t ret = write(fd, buff, len);
+        if (ret < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+            return -1;
+        }
+        buff += ret;
+        len -= ret;
+    }
+    return 0;
+}
+
+// Reads exactly len bytes, a negative timeout waits forever
+static int read_all(int fd, uint8_t* buff, size_t len, int timeout)
+{
+    while (len) {
+        struct pollfd pfd = { fd, POLLIN, 0 };
+        int ret = poll(&pfd, 1, timeout);
+        if (ret < 0 && errno == EINTR) {
+            continue;
+        }
+        if (ret <= 0) {
+            return -1;
+        }
+        ssize_t count = read(fd, buff, len);
+        if (count <= 0) {
+            return -1;
+        }
+        buff += count;
+        len -= count;
+    }
+    return 0;
+}
+
+static void pattern_message(uint8_t* message, unsigned long i)
+{
+    message[0] = USB_MIDI_BENCH_STATUS;
+    message[1] = USB_MIDI_BENCH_DATA1(i);
+    message[2] = USB_MIDI_BENCH_DATA2(i);
+}
+
+static bool check_message(const uint8_t* message, unsigned long i)
+{
+    uint8_t expected[MESSAGE_SIZE];
+    pattern_message(expected, i);
+    return !memcmp(message, expected, MESSAGE_SIZE);
+}
+
+static int send_command(int fd, uint8_t cmd, uint8_t units)
+{
+    uint8_t message[MESSAGE_SIZE] = { USB_MIDI_BENCH_CMD_STATUS, cmd, units };
+    return write_all(fd, message, sizeof(message));
+}
+
+// Waits for the end message of a command, returns its value
+static int read_end(int fd, uint8_t cmd)
+{
+    uint8_t message[MESSAGE_SIZE];
+    if (read_all(fd, message, sizeof(message), TIMEOUT_MS) < 0) {
+        fprintf(stderr, "No end message from the device\n");
+        return -1;
+    }
+    if (message[0] != USB_MIDI_BENCH_CMD_STATUS || message[1] != cmd) {
+        fprintf(stderr, "Unexpected message %02X %02X %02X instead of the end\n",
+                message[0], message[1], message[2]);
+        return -1;
+    }
+    return message[2];
+}
+
+static void print_rate(const char* name, unsigned long events, unsigned long errors, double ms)
+{
+    printf("%-4s rate %8lu events %8.2f events/ms  errors %lu\n",
+           name, events, ms > 0 ? events / ms : 0.0, errors);
+}
+
+// Device sends the pattern as fast as possible
+static int bench_in(int fd, uint8_t units)
+{
+    unsigned long events = (unsigned long)units * USB_MIDI_BENCH_UNIT;
+    unsigned long errors = 0;
+    double start = now_ms();
+    if (send_command(fd, USB_MIDI_BENCH_CMD_IN, units) < 0) {
+        return -1;
+    }
+    for (unsigned long pos = 0; pos < events;) {
+        uint8_t buff[CHUNK * MESSAGE_SIZE];
+        unsigned long len = (events - pos > CHUNK) ? CHUNK : (events - pos);
+        if (read_all(fd, buff, len * MESSAGE_SIZE, TIMEOUT_MS) < 0) {
+            fprintf(stderr, "IN transfer stopped after %lu events\n", pos);
+            return -1;
+        }
+        for (unsigned long i = 0; i < len; i++) {
+            errors += !check_message(&buff[i * MESSAGE_SIZE], pos + i);
+        }
+        pos += len;
+    }
+    double ms = now_ms() - start;
+    if (read_end(fd, USB_MIDI_BENCH_CMD_IN) != 0) {
+        return -1;
+    }
+    print_rate("in", events, errors, ms);
+    return errors ? -1 : 0;
+}
+
+// Device receives and checks the pattern, it answers after the last event
+static int bench_out(int fd, uint8_t units)
+{
+    unsigned long events = (unsigned long)units * USB_MIDI_BENCH_UNIT;
+    double start = now_ms();
+    if (send_command(fd, USB_MIDI_BENCH_CMD_OUT, units) < 0) {
+        return -1;
+    }
+    for (unsigned long pos = 0; pos < events;) {
+        uint8_t buff[CHUNK * MESSAGE_SIZE];
+        unsigned long len = (events - pos > CHUNK) ? CHUNK : (events - pos);
+        for (unsigned long i = 0; i < len; i++) {
+            pattern_message(&buff[i * MESSAGE_SIZE], pos + i);
+        }
+        if (write_all(fd, buff, len * MESSAGE_SIZE) < 0) {
+            fprintf(stderr, "Write failed: %s\n", strerror(errno));
+            return -1;
+        }
+        pos += len;
+    }
+    int errors = read_end(fd, USB_MIDI_BENCH_CMD_OUT);
+    if (errors < 0) {
+        return -1;
+    }
+    print_rate("out", events, errors, now_ms() - start);
+    return errors ? -1 : 0;
+}
+
+static int compare_double(const void* a, const void* b)
+{
+    double x = *(const double*)a;
+    double y = *(const double*)b;
+    return (x > y) - (x < y);
+}
+
+// Ping pong of single events
+static int bench_latency(int fd, unsigned long repetitions)
+{
+    double* times = (double*)malloc(repetitions * sizeof(double));
+    if (!times) {
+        return -1;
+    }
+
+    unsigned long errors = 0;
+    for (unsigned long i = 0; i < repetitions; i++) {
+        uint8_t out[MESSAGE_SIZE];
+        uint8_t in[MESSAGE_SIZE];
+        pattern_message(out, i);
+        double start = now_ms();
+        if (write_all(fd, out, sizeof(out)) < 0 || read_all(fd, in, sizeof(in), TIMEOUT_MS) < 0) {
+            fprintf(stderr, "Echo stopped after %lu events\n", i);
+            free(times);
+            return -1;
+        }
+        times[i] = now_ms() - start;
+        errors += !check_message(in, i);
+    }
+
+    qsort(times, repetitions, sizeof(double), compare_double);
+    double sum = 0;
+    for (unsigned long i = 0; i < repetitions; i++) {
+        sum += times[i];
+    }
+    printf("echo 1 event  min %6.3f avg %6.3f p99 %6.3f max %6.3f ms  errors %lu\n",
+           times[0], sum / repetitions, times[(repetitions * 99) / 100], times[repetitions - 1], errors);
+    free(times);
+    return errors ? -1 : 0;
+}
+
+// Keeps <window> events in flight through the echo
+static int bench_echo_rate(int fd, unsigned long repetitions, unsigned long window)
+{
+    unsigned long sent = 0;
+    unsigned long errors = 0;
+    double start = now_ms();
+    for (unsigned long received = 0; received < repetitions; received++) {
+        while (sent < repetitions && sent - received < window) {
+            uint8_t out[MESSAGE_SIZE];
+            pattern_message(out, sent);
+            if (write_all(fd, out, sizeof(out)) < 0) {
+                fprintf(stderr, "Write failed: %s\n", strerror(errno));
+                return -1;
+            }
+            sent++;
+        }
+        uint8_t in[MESSAGE_SIZE];
+        if (read_all(fd, in, sizeof(in), TIMEOUT_MS) < 0) {
+            fprintf(stderr, "Echo rate test stopped after %lu events\n", received);
+            return -1;
+        }
+        errors += !check_message(in, received);
+    }
+    double ms = now_ms() - start;
+
+    printf("echo rate %8lu events %8.2f events/ms  %lu in flight  errors %lu\n",
+           repetitions, ms > 0 ? repetitions / ms : 0.0, window, errors);
+    return errors ? -1 : 0;
+}
+
+// Local stand-in of the firmware, serving the same protocol on a socket
+static void stand_in(int fd)
+{
+    uint8_t message[MESSAGE_SIZE];
+    while (read_all(fd, message, sizeof(message), -1) == 0) {
+        unsigned long events = (unsigned long)message[2] * USB_MIDI_BENCH_UNIT;
+        if (message[0] == USB_MIDI_BENCH_CMD_STATUS && events && message[1] == USB_MIDI_BENCH_CMD_IN) {
+            for (unsigned long i = 0; i < events; i++) {
+                pattern_message(message, i);
+                if (write_all(fd, message, sizeof(message)) < 0) {
+                    return;
+                }
+            }
+            message[0] = USB_MIDI_BENCH_CMD_STATUS;
+            message[1] = USB_MIDI_BENCH_CMD_IN;
+            message[2] = 0;
+        }
+        else if (message[0] == USB_MIDI_BENCH_CMD_STATUS && events && message[1] == USB_MIDI_BENCH_CMD_OUT) {
+            bool errors = false;
+            for (unsigned long i = 0; i < events; i++) {
+                if (read_all(fd, message, sizeof(message), -1) < 0) {
+                    return;
+                }
+                errors |= !check_message(message, i);
+            }
+            message[0] = USB_MIDI_BENCH_CMD_STATUS;
+            message[1] = USB_MIDI_BENCH_CMD_OUT;
+            message[2] = errors;
+        }
+        if (write_all(fd, message, sizeof(message)) < 0) {
+            return;
+        }
+    }
+}
+
+static int open_stand_in(pid_t* child)
+{
+    int fds[2];
+    if (socketpair(AF_UNIX, SOCK_STREAM, 0, fds) < 0) {
+        fprintf(stderr, "Can't create socket pair: %s\n", strerror(errno));
+        return -1;
+    }
+
+    *child = fork();
+    if (*child < 0) {
+        fprintf(stderr, "Can't start the stand-in: %s\n", strerror(errno));
+        return -1;
+    }
+    if (!*child) {
+        close(fds[0]);
+        stand_in(fds[1]);
+        _exit(0);
+    }
+    close(fds[1]);
+    return fds[0];
+}
+
+int main(int argc, char** argv)
+{
+    const char* device = NULL;
+    unsigned long units = 64;
+    unsigned long repetitions = 1000;
+    unsigned long window = 32;
+    bool local = false;
+
+    int opt;
+    while ((opt = getopt(argc, argv, "d:n:r:w:l")) != -1) {
+        switch (opt) {
+        case 'd': device = optarg; break;
+        case 'n': units = strtoul(optarg, NULL, 0); break;
+        case 'r': repetitions = strtoul(optarg, NULL, 0); break;
+        case 'w': window = strtoul(optarg, NULL, 0); break;
+        case 'l': local = true; break;
+        default:
+            fprintf(stderr, "Usage: %s -d device | -l [-n units] [-r repetitions] [-w window]\n", argv[0]);
+            return 1;
+        }
+    }
+    if ((!device == !local) || !units || units > 127 || !repetitions || !window) {
+        fprintf(stderr, "Invalid arguments, see %s -h\n", argv[0]);
+        return 1;
+    }
+
+    pid_t child = 0;
+    int fd = local ? open_stand_in(&child) : open(device, O_RDWR);
+    if (fd < 0) {
+        if (!local) {
+            fprintf(stderr, "Can't open %s: %s\n", device, strerror(errno));
+        }
+        return 1;
+    }
+    if (local) {
+        printf("Local socket stand-in, the numbers do not describe the device\n");
+    }
+
+    int ret = 0;
+    ret |= bench_in(fd, units);
+    ret |= bench_out(fd, units);
+    ret |= bench_latency(fd, repetitions);
+    ret |= bench_echo_rate(fd, repetitions, window);
+
+    close(fd);
+    if (child > 0) {
+        kill(child, SIGTERM);
+        waitpid(child, NULL, 0);
+    }
+    return ret ? 1 : 0;
+}
@@ -0,0 +1,76 @@
+/*
+Copyright (c) 2018 NicoHood
+See the readme for credit to other people.
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+THE SOFTWARE.
+*/
+
+#pragma once
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// Software version
+#define USB_MIDI_VERSION 100
+
+#include <stdint.h>
+#include <stddef.h>
+#include <stdbool.h>
+#include <LUFA/Drivers/USB/Class/MIDIClass.h>
+
+// Default RX/TX buffer size in 4 byte USB-MIDI event packets.
+// Events are moved between the buffers and the bulk endpoints on every USB
+// start of frame, up to a whole packet (16 events) per endpoint bank.
+// A full RX buffer makes the host wait instead of losing events.
+#ifndef USB_MIDI_BUFFER_RX
+#define USB_MIDI_BUFFER_RX 32
+#endif
+#ifndef USB_MIDI_BUFFER_TX
+#define USB_MIDI_BUFFER_TX 32
+#endif
+
+// Builds an event packet of a channel voice message (note, control change,
+// program change, pressure and pitch bend) for the given virtual cable.
+static inline MIDI_EventPacket_t usb_midi_event(uint8_t cable, uint8_t status, uint8_t data1, uint8_t data2)
+{
+    MIDI_EventPacket_t event = {
+        .Event = MIDI_EVENT(cable, status),
+        .Data1 = status,
+        .Data2 = data1,
+        .Data3 = data2,
+    };
+    return event;
+}
+
+bool usb_midi_connected(void);
+
+// Transmit, returns the number of queued events.
+// Events which do not fit into the buffer are dropped and counted.
+uint8_t usb_midi_write(const MIDI_EventPacket_t* events, uint8_t count);
+uint8_t usb_midi_avail_write(void);
+uint16_t usb_midi_dropped(void);
+
+// Receive, returns the number of events copied into the buffer
+uint8_t usb_midi_read(MIDI_EventPacket_t* events, uint8_t count);
+uint8_t usb_midi_avail_read(void);
+
+#ifdef __cplusplus
+}
+#endif
@@ -0,0 +1,178 @@
+/*
+Copyright (c) 2018 NicoHood
+See the readme for credit to other people.
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+THE SOFTWARE.
+*/
+
+#include <string.h>
+#include "usb.h"
+#include "usb_midi.h"
+
+// Events are addressed with free running 8 bit counters,
+// so the buffers can be filled completely without an extra free slot.
+_Static_assert(USB_MIDI_BUFFER_RX && !(USB_MIDI_BUFFER_RX & (USB_MIDI_BUFFER_RX - 1))
+    && USB_MIDI_BUFFER_RX <= 128,
+    "USB_MIDI_BUFFER_RX must be a power of two. Please choose 1, 2, 4, 8, 16, 32, 64 or 128");
+_Static_assert(USB_MIDI_BUFFER_TX && !(USB_MIDI_BUFFER_TX & (USB_MIDI_BUFFER_TX - 1))
+    && USB_MIDI_BUFFER_TX <= 128,
+    "USB_MIDI_BUFFER_TX must be a power of two. Please choose 1, 2, 4, 8, 16, 32, 64 or 128");
+_Static_assert(sizeof(MIDI_EventPacket_t) == 4, "USB-MIDI event packets must be 4 bytes.");
+
+// Events per bulk packet
+#define USB_MIDI_PACKET_EVENTS (MIDI_STREAM_EPSIZE / sizeof(MIDI_EventPacket_t))
+
+static MIDI_EventPacket_t usb_midi_buffer_rx[USB_MIDI_BUFFER_RX];
+static volatile uint8_t usb_midi_buffer_rx_head = 0;
+static volatile uint8_t usb_midi_buffer_rx_tail = 0;
+static MIDI_EventPacket_t usb_midi_buffer_tx[USB_MIDI_BUFFER_TX];
+static volatile uint8_t usb_midi_buffer_tx_head = 0;
+static volatile uint8_t usb_midi_buffer_tx_tail = 0;
+static uint16_t usb_midi_tx_dropped = 0;
+
+bool usb_midi_configure(void)
+{
+    // Discard events of a previous connection
+    usb_midi_buffer_rx_tail = usb_midi_buffer_rx_head;
+    usb_midi_buffer_tx_tail = usb_midi_buffer_tx_head;
+
+    // Attention! The IN endpoint has the lower number because of ORDERED_EP_CONFIG!
+    return Endpoint_ConfigureEndpoint(MIDI_STREAM_IN_EPADDR, EP_TYPE_BULK, MIDI_STREAM_EPSIZE, MIDI_STREAM_BANKS)
+        && Endpoint_ConfigureEndpoint(MIDI_STREAM_OUT_EPADDR, EP_TYPE_BULK, MIDI_STREAM_EPSIZE, MIDI_STREAM_BANKS);
+}
+
+bool usb_midi_connected(void)
+{
+    return USB_DeviceState == DEVICE_STATE_Configured;
+}
+
+// Called on every USB start of frame by the USB module.
+// Only the RX head and the TX tail get changed here.
+void usb_midi_task(void)
+{
+    if (!usb_midi_connected()) {
+        return;
+    }
+
+    // Pack as many queued events as possible into every free IN bank.
+    // The ring wraps at most once per packet, so it takes two copies at most.
+    Endpoint_SelectEndpoint(MIDI_STREAM_IN_EPADDR);
+    uint8_t tail = usb_midi_buffer_tx_tail;
+    while ((tail != usb_midi_buffer_tx_head) && Endpoint_IsINReady())
+    {
+        uint8_t events = USB_MIDI_PACKET_EVENTS;
+        while (events && (tail != usb_midi_buffer_tx_head))
+        {
+            uint8_t index = tail & (USB_MIDI_BUFFER_TX - 1);
+            uint8_t count = (uint8_t)(usb_midi_buffer_tx_head - tail);
+            if (count > USB_MIDI_BUFFER_TX - index) {
+                count = USB_MIDI_BUFFER_TX - index;
+            }
+            if (count > events) {
+                count = events;
+            }
+            Endpoint_Write_Stream_LE(&usb_midi_buffer_tx[index], count * sizeof(MIDI_EventPacket_t), NULL);
+            tail += count;
+            events -= count;
+        }
+        Endpoint_ClearIN();
+    }
+    usb_midi_buffer_tx_tail = tail;
+
+    // Unpack received banks as long as the events fit into the buffer.
+    // A partially read bank stays selected, the host waits until it is empty.
+    Endpoint_SelectEndpoint(MIDI_STREAM_OUT_EPADDR);
+    uint8_t head = usb_midi_buffer_rx_head;
+    while (Endpoint_IsOUTReceived())
+    {
+        uint8_t events = Endpoint_BytesInEndpoint() / sizeof(MIDI_EventPacket_t);
+        while (events)
+        {
+            uint8_t index = head & (USB_MIDI_BUFFER_RX - 1);
+            uint8_t count = USB_MIDI_BUFFER_RX - (uint8_t)(head - usb_midi_buffer_rx_tail);
+            if (count > USB_MIDI_BUFFER_RX - index) {
+                count = USB_MIDI_BUFFER_RX - index;
+            }
+            if (count > events) {
+                count = events;
+            }
+            if (!count) {
+                break;
+            }
+            Endpoint_Read_Stream_LE(&usb_midi_buffer_rx[index], count * sizeof(MIDI_EventPacket_t), NULL);
+            head += count;
+            events -= count;
+        }
+        if (events) {
+            break;
+        }
+
+        // Incomplete trailing event packets are invalid and discarded
+        Endpoint_ClearOUT();
+    }
+    usb_midi_buffer_rx_head = head;
+}
+
+uint8_t usb_midi_avail_write(void)
+{
+    return USB_MIDI_BUFFER_TX - (uint8_t)(usb_midi_buffer_tx_head - usb_midi_buffer_tx_tail);
+}
+
+uint8_t usb_midi_write(const MIDI_EventPacket_t* events, uint8_t count)
+{
+    uint8_t avail = usb_midi_connected() ? usb_midi_avail_write() : 0;
+    if (count > avail) {
+        usb_midi_tx_dropped += count - avail;
+        count = avail;
+    }
+
+    // Copy first, the events are sent after the head moved
+    uint8_t head = usb_midi_buffer_tx_head;
+    for (uint8_t i = 0; i < count; i++, head++) {
+        usb_midi_buffer_tx[head & (USB_MIDI_BUFFER_TX - 1)] = events[i];
+    }
+    usb_midi_buffer_tx_head = head;
+    return count;
+}
+
+uint16_t usb_midi_dropped(void)
+{
+    return usb_midi_tx_dropped;
+}
+
+uint8_t usb_midi_avail_read(void)
+{
+    return (uint8_t)(usb_midi_buffer_rx_head - usb_midi_buffer_rx_tail);
+}
+
+uint8_t usb_midi_read(MIDI_EventPacket_t* events, uint8_t count)
+{
+    uint8_t avail = usb_midi_avail_read();
+    if (count > avail) {
+        count = avail;
+    }
+
+    // Free the slots after copying them
+    uint8_t tail = usb_midi_buffer_rx_tail;
+    for (uint8_t i = 0; i < count; i++, tail++) {
+        events[i] = usb_midi_buffer_rx[tail & (USB_MIDI_BUFFER_RX - 1)];
+    }
+    usb_midi_buffer_rx_tail = tail;
+    return count;
+}
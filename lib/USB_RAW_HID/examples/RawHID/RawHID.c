@@ -0,0 +1,81 @@
+/*
+Copyright (c) 2018 NicoHood
+See the readme for credit to other people.
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+THE SOFTWARE.
+*/
+
+// Raw HID and CDC echo for the round trip latency comparison of both
+// transfer types. Every raw HID report and every CDC byte is sent back
+// unchanged. Measure it with the host tool in ../../host:
+// usb_raw_hid_test -d /dev/hidraw0 -c /dev/ttyACM0
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <avr/interrupt.h>
+#include "usb.h"
+#include "usb_cdc_serial.h"
+#include "usb_raw_hid.h"
+
+int main(void)
+{
+    // Initialize libraries
+    USB_Init();
+
+    // Enable interrupts
+    sei();
+
+    while (true)
+    {
+        // Move USB data if USB_DEFERRED_TASKS is set
+        usb_task();
+
+        // Only take a report if it can be answered, the host waits meanwhile
+        uint8_t report[USB_RAW_HID_REPORT_SIZE];
+        if (usb_raw_hid_avail_write() && usb_raw_hid_read(report)) {
+            usb_raw_hid_write(report);
+        }
+
+        // Same for the serial port, which has no report boundaries
+        uint8_t buff[CDC_TXRX_EPSIZE];
+        size_t len = usb_cdc_serial_avail_write();
+        if (len > sizeof(buff)) {
+            len = sizeof(buff);
+        }
+        len = usb_cdc_serial_read(buff, len);
+        usb_cdc_serial_write(buff, len);
+    }
+}
+
+/** Event handler for the CDC Class driver Line Encoding Changed event.
+ *
+ *  \param[in] CDCInterfaceInfo  Pointer to the CDC class interface configuration structure being referenced
+ */
+void EVENT_CDC_Device_LineEncodingChanged(USB_ClassInfo_CDC_Device_t* const CDCInterfaceInfo)
+{
+}
+
+/** CDC class driver callback function the processing of changes to the virtual
+ *  control lines sent from the host..
+ *
+ *  \param[in] CDCInterfaceInfo  Pointer to the CDC class interface configuration structure being referenced
+ */
+void EVENT_CDC_Device_ControLineStateChanged(USB_ClassInfo_CDC_Device_t *const CDCInterfaceInfo)
+{
+}
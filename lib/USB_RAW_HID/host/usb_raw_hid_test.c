@@ -0,0 +1,371 @@
+/*
+Copyright (c) 2018 NicoHood
+See the readme for credit to other people.
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+THE SOFTWARE.
+*/
+
+// Host test client of the raw HID echo firmware (examples/RawHID).
+// Measures the round trip latency of single 64 byte reports, the report rate
+// with several reports in flight and, for comparison, the round trip latency
+// of 64 byte messages over the CDC serial port of the same device.
+//
+// Usage: usb_raw_hid_test -d /dev/hidraw0 [-c /dev/ttyACM0] [-r repetitions] [-w window]
+//        usb_raw_hid_test -l [-r repetitions] [-w window]
+// -w sets the number of reports in flight for the rate test, default 4.
+//    More than the device buffers only queue up on the host.
+// -l runs against local stand-ins on socket pairs instead of hardware,
+//    which tests the client without a device (make check).
+//    Its numbers only describe the sockets, not the USB libraries.
+// Returns 1 if any report was wrong or missing.
+
+#define _DEFAULT_SOURCE
+#include <stdint.h>
+#include <stdbool.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <poll.h>
+#include <signal.h>
+#include <termios.h>
+#include <time.h>
+#include <unistd.h>
+#include <sys/socket.h>
+#include <sys/wait.h>
+
+// Report size of the firmware (USB_RAW_HID_REPORT_SIZE)
+#define REPORT_SIZE 64
+
+// Give up if the device does not answer for this time
+#define TIMEOUT_MS 3000
+
+static double now_ms(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec * 1e3 + ts.tv_nsec / 1e6;
+}
+
+static int write_all(int fd, const uint8_t* buff, size_t len)
+{
+    while (len) {
+        ssize_t ret = write(fd, buff, len);
+        if (ret < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+            return -1;
+        }
+        buff += ret;
+        len -= ret;
+    }
+    return 0;
+}
+
+// Reads exactly len bytes, a negative timeout waits forever
+static int read_all(int fd, uint8_t* buff, size_t len, int timeout)
+{
+    while (len) {
+        struct pollfd pfd = { fd, POLLIN, 0 };
+        int ret = poll(&pfd, 1, timeout);
+        if (ret < 0 && errno == EINTR) {
+            continue;
+        }
+        if (ret <= 0) {
+            return -1;
+        }
+        ssize_t count = read(fd, buff, len);
+        if (count <= 0) {
+            return -1;
+        }
+        buff += count;
+        len -= count;
+    }
+    return 0;
+}
+
+// Every report carries its sequence number followed by a pattern
+static void fill_report(uint8_t* report, uint32_t seq)
+{
+    memcpy(report, &seq, sizeof(seq));
+    for (size_t i = sizeof(seq); i < REPORT_SIZE; i++) {
+        report[i] = (uint8_t)(seq + i * 7);
+    }
+}
+
+static bool check_report(const uint8_t* report, uint32_t seq)
+{
+    uint8_t expected[REPORT_SIZE];
+    fill_report(expected, seq);
+    return !memcmp(report, expected, REPORT_SIZE);
+}
+
+// hidraw expects the report ID first, which is 0 for devices without IDs.
+// Reads return the report only.
+static int hid_write(int fd, uint32_t seq)
+{
+    uint8_t buff[1 + REPORT_SIZE] = { 0 };
+    fill_report(&buff[1], seq);
+    return (write(fd, buff, sizeof(buff)) == (ssize_t)sizeof(buff)) ? 0 : -1;
+}
+
+static int hid_read(int fd, uint8_t* report)
+{
+    struct pollfd pfd = { fd, POLLIN, 0 };
+    int ret;
+    do {
+        ret = poll(&pfd, 1, TIMEOUT_MS);
+    } while (ret < 0 && errno == EINTR);
+    if (ret <= 0) {
+        return -1;
+    }
+    return (read(fd, report, REPORT_SIZE) == REPORT_SIZE) ? 0 : -1;
+}
+
+static int compare_double(const void* a, const void* b)
+{
+    double x = *(const double*)a;
+    double y = *(const double*)b;
+    return (x > y) - (x < y);
+}
+
+static void print_latency(const char* name, double* times, unsigned long repetitions, unsigned long errors)
+{
+    qsort(times, repetitions, sizeof(double), compare_double);
+    double sum = 0;
+    for (unsigned long i = 0; i < repetitions; i++) {
+        sum += times[i];
+    }
+    printf("%-4s echo %2u bytes  min %6.3f avg %6.3f p99 %6.3f max %6.3f ms  errors %lu\n",
+           name, REPORT_SIZE, times[0], sum / repetitions, times[(repetitions * 99) / 100],
+           times[repetitions - 1], errors);
+}
+
+// Ping pong of single reports
+static int bench_hid_latency(int fd, unsigned long repetitions)
+{
+    double* times = (double*)malloc(repetitions * sizeof(double));
+    if (!times) {
+        return -1;
+    }
+
+    unsigned long errors = 0;
+    for (unsigned long i = 0; i < repetitions; i++) {
+        uint8_t report[REPORT_SIZE];
+        double start = now_ms();
+        if (hid_write(fd, i) < 0 || hid_read(fd, report) < 0) {
+            fprintf(stderr, "HID echo stopped after %lu reports\n", i);
+            free(times);
+            return -1;
+        }
+        times[i] = now_ms() - start;
+        errors += !check_report(report, i);
+    }
+
+    print_latency("hid", times, repetitions, errors);
+    free(times);
+    return errors ? -1 : 0;
+}
+
+// Keeps <window> reports in flight, the device answers at most one per frame
+static int bench_hid_rate(int fd, unsigned long repetitions, unsigned long window)
+{
+    unsigned long sent = 0;
+    unsigned long errors = 0;
+    double start = now_ms();
+    for (unsigned long received = 0; received < repetitions; received++) {
+        while (sent < repetitions && sent - received < window) {
+            if (hid_write(fd, sent) < 0) {
+                fprintf(stderr, "HID write failed: %s\n", strerror(errno));
+                return -1;
+            }
+            sent++;
+        }
+        uint8_t report[REPORT_SIZE];
+        if (hid_read(fd, report) < 0) {
+            fprintf(stderr, "HID rate test stopped after %lu reports\n", received);
+            return -1;
+        }
+        errors += !check_report(report, received);
+    }
+    double ms = now_ms() - start;
+
+    printf("hid  rate %2lu in flight  %8lu reports %8.2f reports/ms %8.1f KB/s  errors %lu\n",
+           window, repetitions, ms > 0 ? repetitions / ms : 0.0,
+           ms > 0 ? repetitions * REPORT_SIZE / ms : 0.0, errors);
+    return errors ? -1 : 0;
+}
+
+// Ping pong of 64 byte messages over the serial port
+static int bench_cdc_latency(int fd, unsigned long repetitions)
+{
+    double* times = (double*)malloc(repetitions * sizeof(double));
+    if (!times) {
+        return -1;
+    }
+
+    unsigned long errors = 0;
+    for (unsigned long i = 0; i < repetitions; i++) {
+        uint8_t out[REPORT_SIZE];
+        uint8_t in[REPORT_SIZE];
+        fill_report(out, i);
+        double start = now_ms();
+        if (write_all(fd, out, sizeof(out)) < 0 || read_all(fd, in, sizeof(in), TIMEOUT_MS) < 0) {
+            fprintf(stderr, "CDC echo stopped after %lu messages\n", i);
+            free(times);
+            return -1;
+        }
+        times[i] = now_ms() - start;
+        errors += !check_report(in, i);
+    }
+
+    print_latency("cdc", times, repetitions, errors);
+    free(times);
+    return errors ? -1 : 0;
+}
+
+// Local stand-in of the firmware. A datagram socket keeps the report
+// boundaries like hidraw, a stream socket behaves like the serial port.
+static void stand_in(int fd, bool hid)
+{
+    while (true) {
+        uint8_t buff[1 + REPORT_SIZE];
+        ssize_t count = read(fd, buff, sizeof(buff));
+        if (count <= 0) {
+            return;
+        }
+        if (hid) {
+            // Drop the report ID like the kernel does
+            if (count != sizeof(buff) || write_all(fd, &buff[1], REPORT_SIZE) < 0) {
+                return;
+            }
+        }
+        else if (write_all(fd, buff, count) < 0) {
+            return;
+        }
+    }
+}
+
+static int open_stand_in(bool hid, pid_t* child)
+{
+    int fds[2];
+    if (socketpair(AF_UNIX, hid ? SOCK_SEQPACKET : SOCK_STREAM, 0, fds) < 0) {
+        fprintf(stderr, "Can't create socket pair: %s\n", strerror(errno));
+        return -1;
+    }
+
+    *child = fork();
+    if (*child < 0) {
+        fprintf(stderr, "Can't start the stand-in: %s\n", strerror(errno));
+        return -1;
+    }
+    if (!*child) {
+        close(fds[0]);
+        stand_in(fds[1], hid);
+        _exit(0);
+    }
+    close(fds[1]);
+    return fds[0];
+}
+
+static int open_serial(const char* device)
+{
+    int fd = open(device, O_RDWR | O_NOCTTY);
+    if (fd < 0) {
+        fprintf(stderr, "Can't open %s: %s\n", device, strerror(errno));
+        return -1;
+    }
+
+    // Raw mode, opening the port sets DTR, which the device waits for
+    struct termios tty;
+    if (tcgetattr(fd, &tty) == 0) {
+        cfmakeraw(&tty);
+        tcsetattr(fd, TCSANOW, &tty);
+    }
+    tcflush(fd, TCIOFLUSH);
+    return fd;
+}
+
+static void stop_stand_in(pid_t child)
+{
+    if (child > 0) {
+        kill(child, SIGTERM);
+        waitpid(child, NULL, 0);
+    }
+}
+
+int main(int argc, char** argv)
+{
+    const char* hid_device = NULL;
+    const char* cdc_device = NULL;
+    unsigned long repetitions = 1000;
+    unsigned long window = 4;
+    bool local = false;
+
+    int opt;
+    while ((opt = getopt(argc, argv, "d:c:r:w:l")) != -1) {
+        switch (opt) {
+        case 'd': hid_device = optarg; break;
+        case 'c': cdc_device = optarg; break;
+        case 'r': repetitions = strtoul(optarg, NULL, 0); break;
+        case 'w': window = strtoul(optarg, NULL, 0); break;
+        case 'l': local = true; break;
+        default:
+            fprintf(stderr, "Usage: %s -d hidraw [-c tty] | -l [-r repetitions] [-w window]\n", argv[0]);
+            return 1;
+        }
+    }
+    if ((!hid_device == !local) || (cdc_device && local) || !repetitions
+        || repetitions > UINT32_MAX || !window) {
+        fprintf(stderr, "Invalid arguments, see %s -h\n", argv[0]);
+        return 1;
+    }
+
+    pid_t hid_child = 0;
+    pid_t cdc_child = 0;
+    int hid = local ? open_stand_in(true, &hid_child) : open(hid_device, O_RDWR);
+    if (hid < 0) {
+        if (!local) {
+            fprintf(stderr, "Can't open %s: %s\n", hid_device, strerror(errno));
+        }
+        return 1;
+    }
+    if (local) {
+        printf("Local socket stand-ins, the numbers do not describe the device\n");
+    }
+
+    int ret = 0;
+    ret |= bench_hid_latency(hid, repetitions);
+    ret |= bench_hid_rate(hid, repetitions, window);
+    close(hid);
+    stop_stand_in(hid_child);
+
+    if (local || cdc_device) {
+        int cdc = local ? open_stand_in(false, &cdc_child) : open_serial(cdc_device);
+        if (cdc < 0) {
+            return 1;
+        }
+        ret |= bench_cdc_latency(cdc, repetitions);
+        close(cdc);
+        stop_stand_in(cdc_child);
+    }
+    return ret ? 1 : 0;
+}
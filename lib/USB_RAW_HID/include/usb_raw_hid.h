@@ -0,0 +1,66 @@
+/*
+Copyright (c) 2018 NicoHood
+See the readme for credit to other people.
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+THE SOFTWARE.
+*/
+
+#pragma once
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// Software version
+#define USB_RAW_HID_VERSION 100
+
+#include <stdint.h>
+#include <stddef.h>
+#include <stdbool.h>
+#include <LUFA/Drivers/USB/Class/HIDClass.h>
+
+// Vendor defined reports with a fixed size, sent and received every 1ms.
+// Reports are always transferred as a whole, shorter data must be padded.
+#define USB_RAW_HID_REPORT_SIZE 64
+
+// Default RX/TX buffer size in reports (64 bytes RAM each).
+// Reports are moved between the buffers and the endpoints on every USB
+// start of frame. A full RX buffer makes the host wait instead of losing reports.
+#ifndef USB_RAW_HID_BUFFER_RX
+#define USB_RAW_HID_BUFFER_RX 4
+#endif
+#ifndef USB_RAW_HID_BUFFER_TX
+#define USB_RAW_HID_BUFFER_TX 4
+#endif
+
+bool usb_raw_hid_connected(void);
+
+// Transmit, returns false if the buffer is full or the host is not connected
+bool usb_raw_hid_write(const uint8_t* report);
+uint8_t usb_raw_hid_avail_write(void);
+
+// Receive, returns false if no report is available.
+// Reports sent over the control endpoint are dropped if the buffer is full.
+bool usb_raw_hid_read(uint8_t* report);
+uint8_t usb_raw_hid_avail_read(void);
+uint16_t usb_raw_hid_dropped(void);
+
+#ifdef __cplusplus
+}
+#endif
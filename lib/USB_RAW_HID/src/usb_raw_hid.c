@@ -0,0 +1,206 @@
+/*
+Copyright (c) 2018 NicoHood
+See the readme for credit to other people.
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+THE SOFTWARE.
+*/
+
+#include <string.h>
+#include <util/atomic.h>
+#include "usb.h"
+#include "usb_raw_hid.h"
+
+// Reports are addressed with free running 8 bit counters,
+// so the buffers can be filled completely without an extra free slot.
+_Static_assert(USB_RAW_HID_BUFFER_RX && !(USB_RAW_HID_BUFFER_RX & (USB_RAW_HID_BUFFER_RX - 1))
+    && USB_RAW_HID_BUFFER_RX <= 128,
+    "USB_RAW_HID_BUFFER_RX must be a power of two. Please choose 1, 2, 4, 8, 16, 32, 64 or 128");
+_Static_assert(USB_RAW_HID_BUFFER_TX && !(USB_RAW_HID_BUFFER_TX & (USB_RAW_HID_BUFFER_TX - 1))
+    && USB_RAW_HID_BUFFER_TX <= 128,
+    "USB_RAW_HID_BUFFER_TX must be a power of two. Please choose 1, 2, 4, 8, 16, 32, 64 or 128");
+_Static_assert(RAW_HID_EPSIZE == USB_RAW_HID_REPORT_SIZE,
+    "Raw HID reports must fill exactly one packet.");
+
+/** LUFA HID Class driver interface configuration and state information. This structure is
+ *  passed to all HID Class driver functions, so that multiple instances of the same class
+ *  within a device can be differentiated from one another.
+ *  The class driver only handles the IN endpoint, the OUT endpoint is read by usb_raw_hid_task().
+ */
+USB_ClassInfo_HID_Device_t RawHID_HID_Interface =
+    {
+        .Config =
+            {
+                .InterfaceNumber                = INTERFACE_ID_RawHID,
+                .ReportINEndpoint               =
+                    {
+                        .Address                = RAW_HID_IN_EPADDR,
+                        .Size                   = RAW_HID_EPSIZE,
+                        .Banks                  = 1,
+                    },
+                .PrevReportINBuffer             = NULL,
+                .PrevReportINBufferSize         = USB_RAW_HID_REPORT_SIZE,
+            },
+    };
+
+static uint8_t usb_raw_hid_buffer_rx[USB_RAW_HID_BUFFER_RX][USB_RAW_HID_REPORT_SIZE];
+static volatile uint8_t usb_raw_hid_buffer_rx_head = 0;
+static volatile uint8_t usb_raw_hid_buffer_rx_tail = 0;
+static uint8_t usb_raw_hid_buffer_tx[USB_RAW_HID_BUFFER_TX][USB_RAW_HID_REPORT_SIZE];
+static volatile uint8_t usb_raw_hid_buffer_tx_head = 0;
+static volatile uint8_t usb_raw_hid_buffer_tx_tail = 0;
+static uint16_t usb_raw_hid_rx_dropped = 0;
+
+// Last report sent on the IN endpoint, answers GET_REPORT requests
+static uint8_t usb_raw_hid_sent[USB_RAW_HID_REPORT_SIZE];
+
+bool usb_raw_hid_configure(void)
+{
+    // Discard reports of a previous connection
+    usb_raw_hid_buffer_rx_tail = usb_raw_hid_buffer_rx_head;
+    usb_raw_hid_buffer_tx_tail = usb_raw_hid_buffer_tx_head;
+    memset(usb_raw_hid_sent, 0, sizeof(usb_raw_hid_sent));
+
+    // Attention! The IN endpoint has the lower number because of ORDERED_EP_CONFIG!
+    return HID_Device_ConfigureEndpoints(&RawHID_HID_Interface)
+        && Endpoint_ConfigureEndpoint(RAW_HID_OUT_EPADDR, EP_TYPE_INTERRUPT, RAW_HID_EPSIZE, 1);
+}
+
+bool usb_raw_hid_connected(void)
+{
+    return USB_DeviceState == DEVICE_STATE_Configured;
+}
+
+// Called on every USB start of frame by the USB module.
+// Only the RX head and the TX tail get changed here. SET_REPORT requests
+// also write the RX buffer from the control endpoint interrupt, so both
+// writers reserve the slot and move the head atomically.
+void usb_raw_hid_task(void)
+{
+    if (!usb_raw_hid_connected()) {
+        return;
+    }
+
+    // Send the next report, see CALLBACK_HID_RawHID_CreateHIDReport()
+    HID_Device_USBTask(&RawHID_HID_Interface);
+
+    // Receive a report if there is space for it, otherwise the host retries later
+    ATOMIC_BLOCK(ATOMIC_RESTORESTATE)
+    {
+        uint8_t PrevSelectedEndpoint = Endpoint_GetCurrentEndpoint();
+        Endpoint_SelectEndpoint(RAW_HID_OUT_EPADDR);
+        uint8_t head = usb_raw_hid_buffer_rx_head;
+        if (Endpoint_IsOUTReceived()
+            && ((uint8_t)(head - usb_raw_hid_buffer_rx_tail) < USB_RAW_HID_BUFFER_RX))
+        {
+            // Short reports are padded with zeros
+            uint8_t* report = usb_raw_hid_buffer_rx[head & (USB_RAW_HID_BUFFER_RX - 1)];
+            uint8_t bytes = Endpoint_BytesInEndpoint();
+            if (bytes > USB_RAW_HID_REPORT_SIZE) {
+                bytes = USB_RAW_HID_REPORT_SIZE;
+            }
+            memset(report + bytes, 0, USB_RAW_HID_REPORT_SIZE - bytes);
+            Endpoint_Read_Stream_LE(report, bytes, NULL);
+            Endpoint_ClearOUT();
+            usb_raw_hid_buffer_rx_head = head + 1;
+        }
+        Endpoint_SelectEndpoint(PrevSelectedEndpoint);
+    }
+}
+
+bool CALLBACK_HID_RawHID_CreateHIDReport(uint8_t* ReportData, uint16_t* const ReportSize)
+{
+    // Only the interrupt endpoint takes the oldest report from the buffer,
+    // GET_REPORT requests on the control endpoint read the last sent report.
+    bool next = false;
+    uint8_t tail = usb_raw_hid_buffer_tx_tail;
+    if ((Endpoint_GetCurrentEndpoint() == RAW_HID_IN_EPADDR) && (tail != usb_raw_hid_buffer_tx_head))
+    {
+        memcpy(usb_raw_hid_sent, usb_raw_hid_buffer_tx[tail & (USB_RAW_HID_BUFFER_TX - 1)], USB_RAW_HID_REPORT_SIZE);
+        usb_raw_hid_buffer_tx_tail = tail + 1;
+        next = true;
+    }
+
+    memcpy(ReportData, usb_raw_hid_sent, USB_RAW_HID_REPORT_SIZE);
+    *ReportSize = USB_RAW_HID_REPORT_SIZE;
+    return next;
+}
+
+void CALLBACK_HID_RawHID_ProcessHIDReport(const uint8_t* ReportData, uint16_t ReportSize)
+{
+    // Reports sent with SET_REPORT over the control endpoint, by hosts
+    // which do not use the OUT endpoint. They can't wait, so drop them if full.
+    if (ReportSize > USB_RAW_HID_REPORT_SIZE) {
+        ReportSize = USB_RAW_HID_REPORT_SIZE;
+    }
+    ATOMIC_BLOCK(ATOMIC_RESTORESTATE)
+    {
+        uint8_t head = usb_raw_hid_buffer_rx_head;
+        if ((uint8_t)(head - usb_raw_hid_buffer_rx_tail) >= USB_RAW_HID_BUFFER_RX) {
+            usb_raw_hid_rx_dropped++;
+        }
+        else
+        {
+            uint8_t* report = usb_raw_hid_buffer_rx[head & (USB_RAW_HID_BUFFER_RX - 1)];
+            memcpy(report, ReportData, ReportSize);
+            memset(report + ReportSize, 0, USB_RAW_HID_REPORT_SIZE - ReportSize);
+            usb_raw_hid_buffer_rx_head = head + 1;
+        }
+    }
+}
+
+uint8_t usb_raw_hid_avail_write(void)
+{
+    return USB_RAW_HID_BUFFER_TX - (uint8_t)(usb_raw_hid_buffer_tx_head - usb_raw_hid_buffer_tx_tail);
+}
+
+bool usb_raw_hid_write(const uint8_t* report)
+{
+    if (!usb_raw_hid_connected() || !usb_raw_hid_avail_write()) {
+        return false;
+    }
+
+    // Copy first, the report is sent after the head moved
+    uint8_t head = usb_raw_hid_buffer_tx_head;
+    memcpy(usb_raw_hid_buffer_tx[head & (USB_RAW_HID_BUFFER_TX - 1)], report, USB_RAW_HID_REPORT_SIZE);
+    usb_raw_hid_buffer_tx_head = head + 1;
+    return true;
+}
+
+uint16_t usb_raw_hid_dropped(void)
+{
+    return usb_raw_hid_rx_dropped;
+}
+
+uint8_t usb_raw_hid_avail_read(void)
+{
+    return (uint8_t)(usb_raw_hid_buffer_rx_head - usb_raw_hid_buffer_rx_tail);
+}
+
+bool usb_raw_hid_read(uint8_t* report)
+{
+    uint8_t tail = usb_raw_hid_buffer_rx_tail;
+    if (tail == usb_raw_hid_buffer_rx_head) {
+        return false;
+    }
+
+    // Free the slot after copying it
+    memcpy(report, usb_raw_hid_buffer_rx[tail & (USB_RAW_HID_BUFFER_RX - 1)], USB_RAW_HID_REPORT_SIZE);
+    usb_raw_hid_buffer_rx_tail = tail + 1;
+    return true;
+}
@@ -28,180 +28,190 @@ THE SOFTWARE.
 #include "fastled.h"
 #include "fastpin.h"
 #include "board_leds.h"
+#include "adalight.h"
+#include "correction.h"
+#include "interpolation.h"
+#include "telemetry.h"
 #if defined(DMBS_MODULE_USART) && defined(DMBS_MODULE_USB_CDC_SERIAL)
 #error "Only include one serial input DMBS module."
 #elif defined(DMBS_MODULE_USART)
 #include "usart.h"
 #elif defined(DMBS_MODULE_USB_CDC_SERIAL)
+#include "usb.h"
 #include "usb_cdc_serial.h"
 #else
 #error "Please include the USART or the USB_CDC_SERIAL DMBS module."
 #endif
 
-// How many leds are in your strip?
+// How many leds are in your strip? Can also be set in the makefile.
+#ifndef NUM_LEDS
 #define NUM_LEDS 25
+#endif
 
-// For led chips like Neopixels, which have a data line, ground, and power, you just
-// need to define DATA_PIN. For led chipsets that are SPI based (four wires - data, clock,
-// ground, and power), like the LPD8806 define both DATA_PIN and CLOCK_PIN
-#define DATA_PIN 3
-#define CLOCK_PIN 13
-
-// Define the array of leds
-CRGB leds[NUM_LEDS];
-
-// Return values:
-//  1 Data written, update required
-//  0 Active
-// -1 Error
-// -2 Inactive/Timeout
-template <FILE* const stream, CRGB* myleds, const int numLeds, const uint32_t timeout = 15000>
-int adalight(void)
-{
-    static uint32_t previousTime = 0;
-    static uint8_t magicPos = 0;
-    static uint16_t numPixel = 0;
-    static uint8_t pixelCache[2] = { 0, 0 };
-
-    // Process a maximum of 64 bytes.
-    // This is required to not wait too long between each update
-    // but also to not block forever on fast input rates.
-    uint8_t bytesAvailable = 64;
-
-    // Mark adalight as active from here (leds will be overwritten soon!)
-    bool updateLeds = false;
-    bool newData = false;
-    bool error = false;
-    while (bytesAvailable--)
-    {
-        // Write leds via Adalight
-        // Check if any errors occured while reading the new data
-        int input = fgetc(stream);
-        if (input < 0) {
-            break;
-        }
-        newData = true;
-
-        // Get the next magic word letter.
-        // Always check for a new magic word serious, even while processing LED data.
-        uint8_t magicWord;
-        if (magicPos == 0) {
-            magicWord = 'A';
-        }
-        else if (magicPos == 1) {
-            magicWord = 'd';
-        }
-        else if (magicPos == 2) {
-            magicWord = 'a';
-        }
-        else if (magicPos == 3) {
-            magicWord = ((numLeds - 1) >> 8);
-        }
-        else if (magicPos == 4) {
-            magicWord = ((numLeds - 1) & 0xFF);
-        }
-        else { // (magicPos == 5)
-            magicWord = ((numLeds - 1) >> 8) ^ ((numLeds - 1) & 0xFF) ^ 0x55;
-        }
-
-        // Check if input matches magic word
-        if (input == magicWord)
-        {
-            magicPos++;
-        }
-        // Check if input matches the first magic word letter
-        else if (input == 'A') {
-            // Do not flag this case as error, as we are just peeking for a new magic word.
-            // It does not mean, the 'A' received is an error, it can be LED data.
-            magicPos = 1;
-        }
-        // No magic word matched
-        else {
-            magicPos = 0;
+// Large strips (600+ leds) can be split into segments with their own data pin.
+// Each segment is shown as soon as its data was received,
+// which keeps the time with disabled interrupts per show() short.
+#ifndef NUM_SEGMENTS
+#define NUM_SEGMENTS 1
+#endif
+#define SEGMENT_LEDS (NUM_LEDS / NUM_SEGMENTS)
 
-            // Error if we are waiting for a new magic word which is wrong
-            if (!numPixel) {
-                error = true;
-            }
-        }
+// Receive the next frame into a back buffer while the current frame is shown.
+// The shown leds never contain partially received or corrupted frames.
+#ifndef DOUBLE_BUFFER
+#define DOUBLE_BUFFER 1
+#endif
+#if (DOUBLE_BUFFER) && (NUM_SEGMENTS > 1)
+#error "Segments are shown while the frame is received and can't be double buffered."
+#endif
 
-        // Found the magic word! Read leds in the followin iterations.
-        if (magicPos >= 6) {
-            // Error if we got a new magic word when we were still reading led data
-            if (numPixel) {
-                error = true;
-            }
+// Send a pacing token after each update of the leds (ACK/credit flow control).
+// Every token grants the host one credit to send a new frame (see adalight.h).
+#ifndef PACING
+#define PACING 0
+#endif
 
-            // Reset magic word position to detect magic words again.
-            // Optimatically this only happens directly after we received all LED data.
-            magicPos = 0;
-            numPixel = numLeds * 3;
-            continue;
-        }
+// Serial protocol, see adalight.h for the available protocols.
+// Protocols with a checksum after the pixel data (awa, tpm2) should be used
+// with DOUBLE_BUFFER to keep rejected frames out of the led array.
+#ifndef ADALIGHT_PROTOCOL
+#define ADALIGHT_PROTOCOL adalight_protocol_ada
+#endif
 
-        // Proceed Led signal
-        if (numPixel)
-        {
-            // Proceed next pixel
-            numPixel--;
+// Gamma, white point and temporal dithering applied on the device.
+// Disable the gamma correction of the host (e.g. hyperion) if enabled.
+// The corrected frame is shown from its own buffer (NUM_LEDS * 3 bytes RAM).
+// Dithering also refreshes the leds every DITHERING_INTERVAL ms between frames,
+// which requires DOUBLE_BUFFER to not show partially received frames.
+#ifndef CORRECTION
+#define CORRECTION 0
+#endif
+#ifndef GAMMA
+#define GAMMA 25
+#endif
+#ifndef COLOR_CORRECTION
+#define COLOR_CORRECTION 0xFFFFFF
+#endif
+#ifndef DITHERING
+#define DITHERING 1
+#endif
+#ifndef DITHERING_INTERVAL
+#define DITHERING_INTERVAL 10
+#endif
+#define DITHERING_REFRESH ((CORRECTION) && (DITHERING) && (DOUBLE_BUFFER) && (DITHERING_INTERVAL))
+typedef adalight_correction<GAMMA, COLOR_CORRECTION, DITHERING> Correction;
+
+// Render intermediate frames between the last two received frames every
+// INTERPOLATION_INTERVAL ms, to smooth out low host frame rates (e.g. 25fps).
+// The output is delayed by one frame and needs a third frame buffer.
+// Frames further apart than INTERPOLATION_MAX ms are faded in within that time.
+#ifndef INTERPOLATION
+#define INTERPOLATION 0
+#endif
+#ifndef INTERPOLATION_INTERVAL
+#define INTERPOLATION_INTERVAL 10
+#endif
+#ifndef INTERPOLATION_MAX
+#define INTERPOLATION_MAX 100
+#endif
+#if (INTERPOLATION) && !(DOUBLE_BUFFER)
+#error "Interpolation needs the last complete frames and requires DOUBLE_BUFFER."
+#endif
 
-            // Cache a full led pixel to avoid corrupted pixel data when frequently updating.
-            auto pixel = numPixel % 3;
-            if (pixel) {
-                pixelCache[pixel - 1] = input;
-            }
-            else {
-                auto led = (numLeds - 1) - (numPixel / 3);
-                myleds[led].raw[0] = pixelCache[1];
-                myleds[led].raw[1] = pixelCache[0];
-                myleds[led].raw[2] = input;
-            }
+// Frame statistics are sent once per second as text line (see telemetry.h).
+// Set ADALIGHT_TELEMETRY in the makefile, the decoder records the timestamps.
+#if (ADALIGHT_TELEMETRY)
+static adalight_telemetry_t telemetry;
+static uint32_t telemetryReceived = 0;
+static uint32_t telemetryShown = 0;
 
-            // Update Leds if this is the last pixel
-            if (!numPixel) {
-                updateLeds = true;
-                break;
-            }
-        }
+// Called after each complete frame
+static void telemetryFrame(void)
+{
+    // The previous frame was never shown
+    if (telemetryReceived != telemetryShown) {
+        telemetry.dropped++;
     }
+    telemetryReceived = adalight_frame_times().lastByte;
+}
 
-    // On any input reset the timeout
-    auto currentTime = millis();
-    if (newData) {
-        previousTime = currentTime;
-    }
-    // Check if it has timed out before
-    else if (!previousTime)
-    {
-        return -2;
-    }
-    // On no input and a timeout reset temporary variables
-    else if ((currentTime - previousTime) > timeout)
-    {
-        // Clear leds and variables for a clean start
-        memset(myleds, 0x00, numLeds * 3);
-        numPixel = 0;
-        magicPos = 0;
-        previousTime = 0;
-        updateLeds = true;
+// Called after each show(), counts the latest frame once
+static void telemetryShow(uint32_t showStart)
+{
+    if (telemetryReceived != telemetryShown) {
+        adalight_frame_times_t& times = adalight_frame_times();
+        adalight_telemetry_frame(telemetry, times.firstByte, times.lastByte, showStart, micros());
+        telemetryShown = telemetryReceived;
     }
+}
+#endif
 
-    // Flag that the whole led array requires an update
-    if (updateLeds) {
-        return numLeds;
-    }
+// For led chips like Neopixels, which have a data line, ground, and power, you just
+// need to define DATA_PIN. For led chipsets that are SPI based (four wires - data, clock,
+// ground, and power), like the LPD8806 define both DATA_PIN and CLOCK_PIN
+#define DATA_PIN 3
+#define CLOCK_PIN 13
 
-    // Only flag errors if no valid update happened to not block too often
-    if (error) {
-        return -1;
-    }
+// Data pin of the first segment, the following segments use the next pins.
+// Pin 22-29 are on the same port on an Arduino Mega.
+#define SEGMENT_DATA_PIN 22
+
+// Define the array of leds.
+// Frames are received into backLeds, frontLeds holds the last complete frame.
+// Interpolation renders the frames between fromLeds and frontLeds into leds.
+#if (INTERPOLATION)
+CRGB leds[NUM_LEDS];
+static CRGB ledBuffers[3][NUM_LEDS];
+static CRGB* fromLeds = ledBuffers[0];
+static CRGB* frontLeds = ledBuffers[1];
+static CRGB* backLeds = ledBuffers[2];
+#elif (CORRECTION)
+CRGB leds[NUM_LEDS];
+#if (DOUBLE_BUFFER)
+static CRGB ledBuffers[2][NUM_LEDS];
+static CRGB* frontLeds = ledBuffers[0];
+static CRGB* backLeds = ledBuffers[1];
+#else
+static CRGB frontLeds[NUM_LEDS];
+#define backLeds frontLeds
+#endif
+#elif (DOUBLE_BUFFER)
+static CRGB ledBuffers[2][NUM_LEDS];
+static CRGB* leds = ledBuffers[0];
+static CRGB* backLeds = ledBuffers[1];
+#define frontLeds leds
+#else
+CRGB leds[NUM_LEDS];
+#define frontLeds leds
+#define backLeds leds
+#endif
+
+// Serial input
+#if defined(DMBS_MODULE_USART)
+#define adalight_read usart_read
+#define adalight_write usart_write
+#define adalight_task()
+#else
+#define adalight_read usb_cdc_serial_read
+#define adalight_write usb_cdc_serial_write
+#define adalight_task() usb_task()
+#endif
 
-    // No error yet, effect is still running fine.
-    return 0;
+#if (NUM_SEGMENTS > 1)
+// Add one led controller per segment at compile time
+template <uint8_t segment>
+static void addSegments(void)
+{
+    addSegments<segment - 1>();
+    FastLED.addLeds<WS2812B, SEGMENT_DATA_PIN + segment - 1, GRB>(
+        leds + (segment - 1) * SEGMENT_LEDS, SEGMENT_LEDS);
 }
 
-// File Stream
-static FILE AdalightStream;
+template <>
+void addSegments<0>(void)
+{
+}
+#endif
 
 int main(void)
 {
@@ -211,13 +221,11 @@ int main(void)
     FastPin<LED_BUILTIN> pin;
     pin.setOutput();
 
-    // Setup serial input stream
+    // Setup serial input
 #if defined(DMBS_MODULE_USART)
     usart_init();
-    usart_init_stream(&AdalightStream);
 #else
     USB_Init();
-    usb_cdc_serial_init_stream(&AdalightStream);
 #endif
 
     // Initialize libraries and enable interrupts
@@ -238,7 +246,11 @@ int main(void)
     // FastLED.addLeds<GW6205, DATA_PIN, RGB>(leds, NUM_LEDS);
     // FastLED.addLeds<GW6205_400, DATA_PIN, RGB>(leds, NUM_LEDS);
 
+#if (NUM_SEGMENTS > 1)
+    addSegments<NUM_SEGMENTS>();
+#else
     FastLED.addLeds<WS2801, RGB>(leds, NUM_LEDS);
+#endif
     // FastLED.addLeds<SM16716, RGB>(leds, NUM_LEDS);
     // FastLED.addLeds<LPD8806, RGB>(leds, NUM_LEDS);
     // FastLED.addLeds<P9813, RGB>(leds, NUM_LEDS);
@@ -262,14 +274,143 @@ int main(void)
     FastLED.showColor(CRGB::Black);
 
     // Run adalight main loop. Use hyperion on the PC side.
+    // With pacing enabled use host/adalight_send or another credit based sender.
+#if (PACING)
+    static const uint8_t pacingToken = ADALIGHT_PACING_TOKEN;
+    uint32_t pacingTime = millis();
+    adalight_write(&pacingToken, 1);
+#endif
+#if (CORRECTION)
+    // Advances the temporal dithering with every shown frame
+    uint8_t ditherFrame = 0;
+#endif
+#if (INTERPOLATION)
+    // Receive time of the latest frame and the time since the frame before
+    uint32_t frameTime = millis();
+    uint32_t frameInterval = INTERPOLATION_MAX;
+    bool interpolating = false;
+#endif
+#if (INTERPOLATION) || (DITHERING_REFRESH)
+    uint32_t showTime = millis();
+#endif
     while(true)
     {
+        // Move USB data if USB_DEFERRED_TASKS is set
+        adalight_task();
+
         static uint32_t previousTime = 0;
         auto currentTime = millis();
-        auto ret = adalight<&AdalightStream, leds, NUM_LEDS>();
+#if (DOUBLE_BUFFER)
+        // Unchanged pixels of compressed frames are copied from the shown frame
+        auto ret = adalight<adalight_read, NUM_LEDS, SEGMENT_LEDS, 15000, ADALIGHT_PROTOCOL>(backLeds, frontLeds);
+#else
+        auto ret = adalight<adalight_read, NUM_LEDS, SEGMENT_LEDS, 15000, ADALIGHT_PROTOCOL>(backLeds);
+#endif
         if(ret > 0) {
+#if (NUM_SEGMENTS > 1)
+            // Only show the segments which were just completed
+            static uint8_t shownSegments = 0;
+#if (ADALIGHT_TELEMETRY)
+            uint32_t showStart = micros();
+            if (ret == NUM_LEDS) {
+                telemetryFrame();
+            }
+#endif
+#if (CORRECTION)
+            Correction::apply(frontLeds + shownSegments * SEGMENT_LEDS, leds + shownSegments * SEGMENT_LEDS,
+                              ret - shownSegments * SEGMENT_LEDS, ditherFrame);
+            if (ret == NUM_LEDS) {
+                ditherFrame++;
+            }
+#endif
+            for (uint8_t i = shownSegments; i < (ret / SEGMENT_LEDS); i++) {
+                FastLED[i].showLeds(FastLED.getBrightness());
+            }
+#if (ADALIGHT_TELEMETRY)
+            telemetryShow(showStart);
+#endif
+            shownSegments = (ret == NUM_LEDS) ? 0 : (ret / SEGMENT_LEDS);
+#else
+#if (DOUBLE_BUFFER)
+            // Show the received frame and receive the next one into the old frame
+            CRGB* receivedLeds = backLeds;
+#if (INTERPOLATION)
+            // Interpolate from the previous frame, the oldest frame is overwritten
+            backLeds = fromLeds;
+            fromLeds = frontLeds;
+#else
+            backLeds = frontLeds;
+#endif
+            frontLeds = receivedLeds;
+#if !(CORRECTION) && !(INTERPOLATION)
+            FastLED[0].setLeds(leds, NUM_LEDS);
+#endif
+#endif
+#if (ADALIGHT_TELEMETRY)
+            telemetryFrame();
+#endif
+#if (INTERPOLATION)
+            // The previous frame is still shown, the next refresh starts the transition
+            frameInterval = currentTime - frameTime;
+            if (frameInterval > INTERPOLATION_MAX) {
+                frameInterval = INTERPOLATION_MAX;
+            }
+            frameTime = currentTime;
+            interpolating = true;
+#else
+#if (ADALIGHT_TELEMETRY)
+            uint32_t showStart = micros();
+#endif
+#if (CORRECTION)
+            Correction::apply(frontLeds, leds, NUM_LEDS, ditherFrame++);
+#endif
+#if (DITHERING_REFRESH)
+            showTime = currentTime;
+#endif
+            FastLED.show();
+#if (ADALIGHT_TELEMETRY)
+            telemetryShow(showStart);
+#endif
+#endif
+#endif
+
+#if (PACING)
+            // Grant the host a credit for the next frame after the last segment
+            if (ret == NUM_LEDS) {
+                adalight_write(&pacingToken, 1);
+                pacingTime = currentTime;
+            }
+#endif
+        }
+#if (INTERPOLATION)
+        // Show the next intermediate frame (or refresh the dithering)
+        else if ((ret == 0) && (interpolating || DITHERING_REFRESH)
+                 && ((currentTime - showTime) >= INTERPOLATION_INTERVAL))
+        {
+#if (ADALIGHT_TELEMETRY)
+            uint32_t showStart = micros();
+#endif
+            uint8_t amount = adalight_interpolation_amount(currentTime - frameTime, frameInterval);
+            adalight_interpolate(fromLeds, frontLeds, leds, NUM_LEDS, amount);
+            interpolating = (amount != 255);
+#if (CORRECTION)
+            Correction::apply(leds, leds, NUM_LEDS, ditherFrame++);
+#endif
+            showTime = currentTime;
+            FastLED.show();
+#if (ADALIGHT_TELEMETRY)
+            telemetryShow(showStart);
+#endif
+        }
+#elif (DITHERING_REFRESH)
+        // Show the last frame with the next dithering threshold
+        else if ((ret == 0) && ((currentTime - showTime) >= DITHERING_INTERVAL))
+        {
+            Correction::apply(frontLeds, leds, NUM_LEDS, ditherFrame++);
+            showTime = currentTime;
             FastLED.show();
         }
+#endif
         // Temporary error
         else if (ret == -1)
         {
@@ -282,7 +423,30 @@ int main(void)
         {
             // Do other effects or keep updating LEDs to ensure they are off.
             FastLED.show();
+
+#if (PACING)
+            // Repeat the credit while idle, in case the host lost it (e.g. on restart)
+            if ((currentTime - pacingTime) > 1000UL) {
+                adalight_write(&pacingToken, 1);
+                pacingTime = currentTime;
+            }
+#endif
+        }
+
+#if (ADALIGHT_TELEMETRY)
+        // Report the statistics of the last second if anything was received
+        static uint32_t telemetryTime = 0;
+        if ((currentTime - telemetryTime) >= 1000UL)
+        {
+            adalight_frame_times_t& times = adalight_frame_times();
+            if (telemetry.frames || times.partialFrames || times.syncErrors) {
+                char line[ADALIGHT_TELEMETRY_LINE];
+                size_t len = adalight_telemetry_report(telemetry, currentTime - telemetryTime, line);
+                adalight_write((const uint8_t*)line, len);
+            }
+            telemetryTime = currentTime;
         }
+#endif
 
         // Turn error led off after one second
         if ((currentTime - previousTime) > 1000UL)
@@ -0,0 +1,532 @@
+/*
+Copyright (c) 2017 NicoHood
+See the readme for credit to other people.
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+THE SOFTWARE.
+*/
+
+// Include guard
+#pragma once
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <string.h>
+#include <stdio.h>
+#include "timer0.h"
+#include "fastled.h"
+
+// Minimum number of bytes processed per call
+#ifndef ADALIGHT_BUDGET_MIN
+#define ADALIGHT_BUDGET_MIN 64
+#endif
+
+// Interval in ms to measure the serial input rate.
+// The budget is sized to process all bytes that arrive within 2ms per call.
+#ifndef ADALIGHT_RATE_INTERVAL
+#define ADALIGHT_RATE_INTERVAL 32
+#endif
+
+// Reads up to len bytes into buff and returns the number of bytes read.
+// Available in all serial modules, e.g. usart_read() or usb_cdc_serial_read().
+typedef size_t (*adalight_read_t)(uint8_t* buff, size_t len);
+
+// Pacing token, sent by the device after each show() if pacing is enabled.
+// Each token grants the host a credit to send one frame. The host starts with
+// a single credit, so no data is sent while the leds are updated with disabled
+// interrupts. More credits can be used if no data is lost during show(),
+// e.g. with USB CDC serial, which holds back data on the USB bus instead.
+// The device also sends the token on startup and every second while idle.
+#define ADALIGHT_PACING_TOKEN 'k'
+
+// Record the receive time of each frame and count broken frames,
+// see adalight_frame_times(). Requires micros() from the TIMER0 module.
+#ifndef ADALIGHT_TELEMETRY
+#define ADALIGHT_TELEMETRY 0
+#endif
+
+struct adalight_frame_times_t {
+    uint32_t firstByte;     // micros() of the first header byte of the last frame
+    uint32_t lastByte;      // micros() when the last frame was complete
+    uint16_t partialFrames; // Frames aborted after a valid header
+    uint16_t syncErrors;    // Bytes received outside of a frame
+};
+
+static inline adalight_frame_times_t& adalight_frame_times(void)
+{
+    static adalight_frame_times_t times;
+    return times;
+}
+
+// Compressed frames use the magic word "Adc" instead of "Ada".
+// The pixel data is a sequence of ops, each starting with a control byte.
+// The upper 2 bits select the op, the lower 6 bits hold the pixel count - 1.
+// Raw "Ada" frames are still supported, so older hosts keep working.
+#ifndef ADALIGHT_COMPRESSION
+#define ADALIGHT_COMPRESSION 1
+#endif
+#define ADALIGHT_OP_LITERAL     0x00 // Pixels follow as raw RGB data
+#define ADALIGHT_OP_RUN         0x40 // One RGB pixel follows, repeated count times
+#define ADALIGHT_OP_SKIP        0x80 // Pixels are unchanged since the previous frame
+#define ADALIGHT_OP_MASK        0xC0
+#define ADALIGHT_OP_MAX_COUNT   64
+
+// Protocols are selected at compile time, only the used one is compiled.
+// A protocol is a class template (parameter is the led count) with:
+//  State                           Variables of the current frame
+//  headerSize, trailerSize         Bytes before and after the pixel data
+//  header(state, pos, input)       Returns true if the header byte is valid
+//  length(state)                   Bytes of pixel data announced by the header
+//  compressed(state)               Pixel data consists of compression ops
+//  checksum(state, data, len)      Called for all pixel data, in order
+//  trailer(state, pos, input)      Returns true if the trailer byte is valid
+// The pixel data itself is always read directly into the led array.
+
+// Adalight: "Ada", led count - 1 (high, low byte), checksum, RGB data.
+// "Adc" frames contain compressed pixel data.
+template <uint16_t numLeds>
+struct adalight_protocol_ada
+{
+    struct State {
+        bool compressed;
+    };
+    static const uint8_t headerSize = 6;
+    static const uint8_t trailerSize = 0;
+
+    static bool header(State& state, uint8_t pos, uint8_t input)
+    {
+        static const uint8_t magic[headerSize] = {
+            'A', 'd', 'a',
+            ((numLeds - 1) >> 8),
+            ((numLeds - 1) & 0xFF),
+            ((numLeds - 1) >> 8) ^ ((numLeds - 1) & 0xFF) ^ 0x55
+        };
+        if (pos == 2) {
+            state.compressed = ADALIGHT_COMPRESSION && (input == 'c');
+            if (state.compressed) {
+                return true;
+            }
+        }
+        return input == magic[pos];
+    }
+    static uint16_t length(State&) { return numLeds * 3; }
+    static bool compressed(State& state) { return state.compressed; }
+    static void checksum(State&, const uint8_t*, uint16_t) {}
+    static bool trailer(State&, uint8_t, uint8_t) { return true; }
+};
+
+// AWA (HyperSerial): "Awa", led count - 1 (high, low byte), checksum, RGB data
+// followed by the Fletcher checksums of the pixel data.
+template <uint16_t numLeds>
+struct adalight_protocol_awa
+{
+    struct State {
+        uint16_t position;
+        uint8_t fletcher1;
+        uint8_t fletcher2;
+        uint8_t fletcherExt;
+    };
+    static const uint8_t headerSize = 6;
+    static const uint8_t trailerSize = 3;
+
+    static bool header(State& state, uint8_t pos, uint8_t input)
+    {
+        static const uint8_t magic[headerSize] = {
+            'A', 'w', 'a',
+            ((numLeds - 1) >> 8),
+            ((numLeds - 1) & 0xFF),
+            ((numLeds - 1) >> 8) ^ ((numLeds - 1) & 0xFF) ^ 0x55
+        };
+        state.position = 0;
+        state.fletcher1 = 0;
+        state.fletcher2 = 0;
+        state.fletcherExt = 0;
+        return input == magic[pos];
+    }
+    static uint16_t length(State&) { return numLeds * 3; }
+    static bool compressed(State&) { return false; }
+
+    // Sums modulo 255 without divisions
+    static uint8_t add255(uint8_t a, uint8_t b)
+    {
+        uint16_t sum = a + b;
+        if (sum >= 255) {
+            sum -= 255;
+        }
+        return sum;
+    }
+
+    static void checksum(State& state, const uint8_t* data, uint16_t len)
+    {
+        while (len--) {
+            uint8_t input = *data++;
+            state.fletcher1 = add255(state.fletcher1, input);
+            state.fletcher2 = add255(state.fletcher2, state.fletcher1);
+
+            // (input ^ position) % 255, with 256 % 255 == 1
+            uint16_t ext = input ^ state.position++;
+            state.fletcherExt = add255(state.fletcherExt, add255(ext >> 8, ext & 0xFF));
+        }
+    }
+
+    static bool trailer(State& state, uint8_t pos, uint8_t input)
+    {
+        if (pos == 0) {
+            return input == state.fletcher1;
+        }
+        if (pos == 1) {
+            return input == state.fletcher2;
+        }
+        // 0x41 ('A') is sent as 0xAA to not be confused with a new header
+        return input == ((state.fletcherExt == 0x41) ? 0xAA : state.fletcherExt);
+    }
+};
+
+// TPM2: 0xC9, 0xDA (data frame), data length (high, low byte), RGB data, 0x36.
+// Frames with less data only update the first leds, additional data is ignored.
+template <uint16_t numLeds>
+struct adalight_protocol_tpm2
+{
+    struct State {
+        uint16_t length;
+    };
+    static const uint8_t headerSize = 4;
+    static const uint8_t trailerSize = 1;
+
+    static bool header(State& state, uint8_t pos, uint8_t input)
+    {
+        if (pos == 0) {
+            return input == 0xC9;
+        }
+        if (pos == 1) {
+            return input == 0xDA;
+        }
+        if (pos == 2) {
+            state.length = input << 8;
+        }
+        else {
+            state.length |= input;
+        }
+        return true;
+    }
+    static uint16_t length(State& state) { return state.length; }
+    static bool compressed(State&) { return false; }
+    static void checksum(State&, const uint8_t*, uint16_t) {}
+    static bool trailer(State&, uint8_t, uint8_t input) { return input == 0x36; }
+};
+
+// Pixel data is written into myleds, which can be changed between frames
+// to receive into a back buffer while the front buffer is shown.
+// Skipped pixels of compressed frames (and leds missing in shorter frames)
+// are copied from previous, or left untouched in myleds if previous is NULL.
+// Large led strips can be split into segments of segmentLeds each,
+// which can be shown while the next segment is still being received.
+// This is not possible with protocols that verify the frame afterwards.
+//
+// Return values:
+// >0 Data written, the first n leds require an update
+//  0 Active
+// -1 Error
+// -2 Inactive/Timeout
+template <adalight_read_t read, const uint16_t numLeds,
+          const uint16_t segmentLeds = numLeds, const uint32_t timeout = 15000,
+          template <uint16_t> class protocol = adalight_protocol_ada>
+int adalight(CRGB* myleds, const CRGB* previous = NULL)
+{
+    typedef protocol<numLeds> Protocol;
+    static_assert((numLeds % segmentLeds) == 0, "Led count must be a multiple of the segment size");
+    static_assert(numLeds <= (UINT16_MAX / 3), "Too many leds");
+    static_assert((segmentLeds == numLeds) || (Protocol::trailerSize == 0),
+                  "Segments can't be used with protocols that verify the frame afterwards");
+
+    static const uint16_t numBytes = numLeds * 3;
+    static const uint16_t segmentBytes = segmentLeds * 3;
+
+    static uint32_t previousTime = 0;
+    static typename Protocol::State state;
+    static uint8_t headerPos = 0;
+    static uint8_t trailerPos = 0;
+    static bool compressed = false;
+    static uint16_t bytePos = 0;
+    static uint16_t segmentEnd = segmentBytes;
+
+    // Pixel bytes to read from the input, to repeat afterwards (runs)
+    // and to ignore (more data than leds)
+    static uint16_t pending = 0;
+    static uint16_t repeat = 0;
+    static uint16_t discard = 0;
+
+    // Process a limited number of bytes per call.
+    // This is required to not wait too long between each update
+    // but also to not block forever on fast input rates.
+    // The budget follows the measured serial rate to keep up with large frames.
+    static uint16_t budget = ADALIGHT_BUDGET_MIN;
+    static uint16_t rateBytes = 0;
+    static uint32_t rateTime = 0;
+    uint16_t bytesAvailable = budget;
+
+    adalight_frame_times_t& times = adalight_frame_times();
+
+    // Mark adalight as active from here (leds will be overwritten soon!)
+    uint8_t* pixels = (uint8_t*)myleds;
+    int updateLeds = 0;
+    bool newData = false;
+    bool error = false;
+    while (bytesAvailable)
+    {
+        // Search for the header byte by byte
+        if (headerPos < Protocol::headerSize)
+        {
+            uint8_t input;
+            if (!read(&input, 1)) {
+                break;
+            }
+            newData = true;
+            bytesAvailable--;
+
+            // Check if input matches the header
+            if (Protocol::header(state, headerPos, input)) {
+                headerPos++;
+            }
+            // Check if input matches the first header byte.
+            // Do not flag this case as error, it might be the start of a new header.
+            else if (Protocol::header(state, 0, input)) {
+                headerPos = 1;
+            }
+            // Error if we are waiting for a new header which is wrong
+            else {
+                headerPos = 0;
+                error = true;
+                if (ADALIGHT_TELEMETRY) {
+                    times.syncErrors++;
+                }
+            }
+            if (ADALIGHT_TELEMETRY && (headerPos == 1)) {
+                times.firstByte = micros();
+            }
+
+            // Raw frames read all pixel data directly
+            if (headerPos == Protocol::headerSize) {
+                uint16_t length = Protocol::length(state);
+                compressed = Protocol::compressed(state);
+                pending = compressed ? 0 : ((length < numBytes) ? length : numBytes);
+                discard = compressed ? 0 : (length - pending);
+                repeat = 0;
+                trailerPos = 0;
+            }
+            continue;
+        }
+
+        // Copy as much pixel data as possible directly into the led array.
+        // The serial data is in the same order as the raw CRGB memory layout.
+        // Lost bytes are not detected inside the pixel data, but with the
+        // trailer or the following (then misaligned) header instead.
+        if (pending)
+        {
+            uint16_t len = pending;
+            if (len > bytesAvailable) {
+                len = bytesAvailable;
+            }
+            if (len > segmentEnd - bytePos) {
+                len = segmentEnd - bytePos;
+            }
+            len = read(pixels + bytePos, len);
+            if (!len) {
+                break;
+            }
+            newData = true;
+            Protocol::checksum(state, pixels + bytePos, len);
+            bytesAvailable -= len;
+            bytePos += len;
+            pending -= len;
+
+            // Repeat the pixel of a run
+            if (!pending && repeat) {
+                uint8_t* pos = pixels + bytePos;
+                for (uint16_t i = 0; i < repeat; i++) {
+                    pos[i] = pos[i - 3];
+                }
+                bytePos += repeat;
+                repeat = 0;
+            }
+        }
+        // Read the next op of a compressed frame
+        else if (ADALIGHT_COMPRESSION && compressed && (bytePos < numBytes))
+        {
+            uint8_t control;
+            if (!read(&control, 1)) {
+                break;
+            }
+            newData = true;
+            bytesAvailable--;
+
+            uint16_t len = ((control & ~ADALIGHT_OP_MASK) + 1) * 3;
+            uint8_t op = control & ADALIGHT_OP_MASK;
+            if ((len > (numBytes - bytePos)) || (op == ADALIGHT_OP_MASK)) {
+                // Invalid op, search for the next header
+                headerPos = 0;
+                bytePos = 0;
+                segmentEnd = segmentBytes;
+                error = true;
+                if (ADALIGHT_TELEMETRY) {
+                    times.partialFrames++;
+                }
+                continue;
+            }
+            if (op == ADALIGHT_OP_LITERAL) {
+                pending = len;
+            }
+            else if (op == ADALIGHT_OP_RUN) {
+                pending = 3;
+                repeat = len - 3;
+            }
+            else {
+                if (previous) {
+                    memcpy(pixels + bytePos, ((const uint8_t*)previous) + bytePos, len);
+                }
+                bytePos += len;
+            }
+        }
+        // Ignore data for more leds than available
+        else if (discard)
+        {
+            uint8_t buff[16];
+            uint16_t len = discard;
+            if (len > sizeof(buff)) {
+                len = sizeof(buff);
+            }
+            if (len > bytesAvailable) {
+                len = bytesAvailable;
+            }
+            len = read(buff, len);
+            if (!len) {
+                break;
+            }
+            newData = true;
+            Protocol::checksum(state, buff, len);
+            bytesAvailable -= len;
+            discard -= len;
+        }
+        // Verify the frame
+        else if (trailerPos < Protocol::trailerSize)
+        {
+            uint8_t input;
+            if (!read(&input, 1)) {
+                break;
+            }
+            newData = true;
+            bytesAvailable--;
+
+            if (!Protocol::trailer(state, trailerPos, input)) {
+                // Invalid frame, search for the next header
+                headerPos = 0;
+                bytePos = 0;
+                segmentEnd = segmentBytes;
+                error = true;
+                if (ADALIGHT_TELEMETRY) {
+                    times.partialFrames++;
+                }
+                continue;
+            }
+            trailerPos++;
+        }
+
+        // Update Leds if this was the last pixel of the frame
+        bool dataComplete = !pending && !discard && (!compressed || (bytePos >= numBytes));
+        if (dataComplete && (trailerPos >= Protocol::trailerSize)) {
+            // Keep leds which were not part of a shorter frame
+            if (previous && (bytePos < numBytes)) {
+                memcpy(pixels + bytePos, ((const uint8_t*)previous) + bytePos, numBytes - bytePos);
+            }
+            updateLeds = numLeds;
+            headerPos = 0;
+            bytePos = 0;
+            segmentEnd = segmentBytes;
+            if (ADALIGHT_TELEMETRY) {
+                times.lastByte = micros();
+            }
+            break;
+        }
+
+        // Update Leds if this was the last pixel of a segment
+        if (!Protocol::trailerSize && (bytePos >= segmentEnd)) {
+            do {
+                segmentEnd += segmentBytes;
+            } while (segmentEnd <= bytePos);
+            updateLeds = (segmentEnd - segmentBytes) / 3;
+            break;
+        }
+    }
+
+    // On any input reset the timeout
+    auto currentTime = millis();
+    if (newData) {
+        previousTime = currentTime;
+    }
+    // Check if it has timed out before
+    else if (!previousTime)
+    {
+        return -2;
+    }
+    // On no input and a timeout reset temporary variables
+    else if ((currentTime - previousTime) > timeout)
+    {
+        // Clear leds and variables for a clean start
+        if (ADALIGHT_TELEMETRY && (headerPos == Protocol::headerSize)) {
+            times.partialFrames++;
+        }
+        memset(myleds, 0x00, numBytes);
+        headerPos = 0;
+        bytePos = 0;
+        segmentEnd = segmentBytes;
+        pending = 0;
+        repeat = 0;
+        discard = 0;
+        previousTime = 0;
+        updateLeds = numLeds;
+    }
+
+    // Measure the serial rate and adapt the budget
+    rateBytes += budget - bytesAvailable;
+    if ((currentTime - rateTime) >= ADALIGHT_RATE_INTERVAL)
+    {
+        budget = rateBytes / (ADALIGHT_RATE_INTERVAL / 2);
+        if (budget < ADALIGHT_BUDGET_MIN) {
+            budget = ADALIGHT_BUDGET_MIN;
+        }
+        else if (budget > numBytes) {
+            budget = numBytes;
+        }
+        rateBytes = 0;
+        rateTime = currentTime;
+    }
+
+    // Flag that the led array (or a part of it) requires an update
+    if (updateLeds) {
+        return updateLeds;
+    }
+
+    // Only flag errors if no valid update happened to not block too often
+    if (error) {
+        return -1;
+    }
+
+    // No error yet, effect is still running fine.
+    return 0;
+}
@@ -0,0 +1,103 @@
+/*
+Copyright (c) 2018 NicoHood
+See the readme for credit to other people.
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+THE SOFTWARE.
+*/
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <string.h>
+#include "timer0.h"
+#include "fastled.h"
+#include "adalight.h"
+#include "correction.h"
+#include "interpolation.h"
+#include "bench.h"
+
+// Same led count as the Adalight project
+#define NUM_LEDS 25
+
+// Define the array of leds
+CRGB leds[NUM_LEDS];
+
+// The correction stage is measured per 100 leds.
+// At 100 frames per second a 16MHz AVR has 160000 cycles per frame.
+#define CORRECTION_LEDS 100
+static CRGB correctionInput[CORRECTION_LEDS];
+static CRGB correctionOutput[CORRECTION_LEDS];
+typedef adalight_correction<25, 0xFFB0F0, false> Correction;
+typedef adalight_correction<25, 0xFFB0F0, true> DitheredCorrection;
+
+// Interpolation renders 100 frames per second, each followed by show().
+// The maximum led count at 100Hz is 160000 / (cycles per led + show cycles per led),
+// e.g. 160000 / (interpolation_100 / 100 + 480) for WS2812 (30us per led).
+static CRGB interpolationOutput[CORRECTION_LEDS];
+
+// A complete Adalight frame (header + pixel data) is read from RAM.
+// Divide the frame size by the reported cycles to get the bytes per cycle.
+// 2Mbaud on a 16MHz AVR requires less than 80 cycles per byte.
+static uint8_t frame[6 + NUM_LEDS * 3];
+static uint16_t framePos = 0;
+
+static size_t bench_read(uint8_t* buff, size_t len)
+{
+    size_t count = sizeof(frame) - framePos;
+    if (count > len) {
+        count = len;
+    }
+    memcpy(buff, &frame[framePos], count);
+    framePos += count;
+    return count;
+}
+
+int main(void)
+{
+    // Initialize libraries
+    bench_init();
+
+    // Generate a valid frame header with some pixel data
+    frame[0] = 'A';
+    frame[1] = 'd';
+    frame[2] = 'a';
+    frame[3] = (NUM_LEDS - 1) >> 8;
+    frame[4] = (NUM_LEDS - 1) & 0xFF;
+    frame[5] = frame[3] ^ frame[4] ^ 0x55;
+    for (uint16_t i = 6; i < sizeof(frame); i++) {
+        frame[i] = i;
+    }
+
+    // Decode a full frame (81 bytes), which may take multiple calls
+    BENCH("adalight_frame", while (adalight<bench_read, NUM_LEDS>(leds) <= 0));
+
+    // Gamma and color correction of 100 leds, with and without dithering
+    for (uint16_t i = 0; i < sizeof(correctionInput); i++) {
+        ((uint8_t*)correctionInput)[i] = i;
+    }
+    BENCH("correction_100", Correction::apply(correctionInput, correctionOutput, CORRECTION_LEDS, 0));
+    BENCH("correction_dither_100", DitheredCorrection::apply(correctionInput, correctionOutput, CORRECTION_LEDS, 1));
+
+    // Intermediate frame of 100 leds, with and without correction
+    BENCH("interpolation_100", adalight_interpolate(correctionInput, correctionOutput,
+                                                    interpolationOutput, CORRECTION_LEDS, 100));
+    BENCH("interpolation_dither_100",
+          adalight_interpolate(correctionInput, correctionOutput, interpolationOutput, CORRECTION_LEDS, 100);
+          DitheredCorrection::apply(interpolationOutput, interpolationOutput, CORRECTION_LEDS, 2));
+    bench_exit();
+}
@@ -0,0 +1,161 @@
+/*
+Copyright (c) 2018 NicoHood
+See the readme for credit to other people.
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+THE SOFTWARE.
+*/
+
+// Include guard
+#pragma once
+
+#include <stdint.h>
+#include <avr/pgmspace.h>
+#include "fastled.h"
+
+// Gamma, white point and per channel maximum are combined into one lookup
+// table per channel. The tables are calculated at compile time and stored in
+// flash. Channels with equal settings share the same table.
+// With temporal dithering the tables hold 8.8 fixed point values.
+// The fraction is added up over multiple frames with a threshold, which
+// changes with every frame, so the average matches the exact value.
+
+// Compile time math for the lookup tables
+constexpr double adalight_square(double x)
+{
+    return x * x;
+}
+
+// ln(x) = 2 * atanh((x - 1) / (x + 1)), converges fast for 0.5 <= x <= 1
+constexpr double adalight_atanh(double y, double y2, double term, uint8_t n)
+{
+    return (n > 41) ? 0 : (term / n + adalight_atanh(y, y2, term * y2, n + 2));
+}
+
+constexpr double adalight_ln(double x)
+{
+    return (x < 0.5) ? (adalight_ln(x * 2) - 0.69314718055994530942)
+           : 2 * adalight_atanh((x - 1) / (x + 1), adalight_square((x - 1) / (x + 1)), (x - 1) / (x + 1), 1);
+}
+
+constexpr double adalight_exp_series(double x, double term, uint8_t n)
+{
+    return (n > 20) ? term : (term + adalight_exp_series(x, term * x / n, n + 1));
+}
+
+// exp(x) = exp(x / 2)^2, for x <= 0
+constexpr double adalight_exp(double x)
+{
+    return (x < -0.5) ? adalight_square(adalight_exp(x / 2)) : adalight_exp_series(x, 1, 1);
+}
+
+// (input / 255)^(gamma / 10) * max * scale, rounded
+constexpr double adalight_gamma(uint8_t gamma10, uint8_t max, uint16_t scale, uint8_t input)
+{
+    return (input == 0) ? 0
+           : adalight_exp(adalight_ln(input / 255.0) * gamma10 / 10.0) * max * scale + 0.5;
+}
+
+// Index list 0..255 to initialize the tables
+template <uint16_t... I>
+struct adalight_indices {};
+
+template <uint16_t N, uint16_t... I>
+struct adalight_range : adalight_range<N - 1, N - 1, I...> {};
+
+template <uint16_t... I>
+struct adalight_range<0, I...>
+{
+    typedef adalight_indices<I...> type;
+};
+
+template <typename T, uint8_t gamma10, uint8_t max, typename indices = typename adalight_range<256>::type>
+struct adalight_lut;
+
+template <typename T, uint8_t gamma10, uint8_t max, uint16_t... I>
+struct adalight_lut<T, gamma10, max, adalight_indices<I...>>
+{
+    static const T table[256];
+};
+
+template <typename T, uint8_t gamma10, uint8_t max, uint16_t... I>
+const T adalight_lut<T, gamma10, max, adalight_indices<I...>>::table[256] PROGMEM = {
+    (T)adalight_gamma(gamma10, max, (sizeof(T) > 1) ? 256 : 1, I)...
+};
+
+// 8 bit tables without dithering, 8.8 fixed point tables with dithering
+template <bool dithering>
+struct adalight_lut_type
+{
+    typedef uint8_t type;
+};
+
+template <>
+struct adalight_lut_type<true>
+{
+    typedef uint16_t type;
+};
+
+// gamma10: Gamma * 10, e.g. 25 for 2.5 or 10 for a linear output.
+// colorCorrection: Maximum of each channel as 0xRRGGBB, e.g. 0xFFB0F0 for
+// typical WS2812 strips, which are too blue and green otherwise.
+// dithering: Use the fraction of the tables with temporal dithering.
+template <uint8_t gamma10, uint32_t colorCorrection, bool dithering>
+struct adalight_correction
+{
+    typedef typename adalight_lut_type<dithering>::type value_t;
+    typedef adalight_lut<value_t, gamma10, (colorCorrection >> 16) & 0xFF> red;
+    typedef adalight_lut<value_t, gamma10, (colorCorrection >> 8) & 0xFF> green;
+    typedef adalight_lut<value_t, gamma10, colorCorrection & 0xFF> blue;
+
+    static uint8_t lookup(const uint8_t* table, uint8_t input, uint8_t)
+    {
+        return pgm_read_byte(&table[input]);
+    }
+
+    // The threshold can't overflow, the maximum table value is 255 * 256
+    static uint8_t lookup(const uint16_t* table, uint8_t input, uint8_t threshold)
+    {
+        return (pgm_read_word(&table[input]) + threshold) >> 8;
+    }
+
+    // Writes the corrected pixels of input into output.
+    // frame should be increased with every shown frame for temporal dithering.
+    static void apply(const CRGB* input, CRGB* output, uint16_t numLeds, uint8_t frame)
+    {
+        // The bit reversed frame counter spreads the thresholds evenly over
+        // consecutive frames. Neighboured leds use the opposite threshold,
+        // so the strip does not flicker in sync.
+        uint8_t threshold = 0;
+        for (uint8_t i = 0; i < 8; i++) {
+            threshold = (threshold << 1) | (frame & 0x01);
+            frame >>= 1;
+        }
+
+        const uint8_t* in = (const uint8_t*)input;
+        uint8_t* out = (uint8_t*)output;
+        while (numLeds--) {
+            out[0] = lookup(red::table, in[0], threshold);
+            out[1] = lookup(green::table, in[1], threshold);
+            out[2] = lookup(blue::table, in[2], threshold);
+            in += 3;
+            out += 3;
+            threshold ^= 0x80;
+        }
+    }
+};
@@ -0,0 +1,146 @@
+/*
+Copyright (c) 2018 NicoHood
+See the readme for credit to other people.
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+THE SOFTWARE.
+*/
+
+// Host side encoders for compressed Adalight, AWA and TPM2 frames (see adalight.h)
+#pragma once
+
+#include <stdint.h>
+#include <stddef.h>
+#include <string.h>
+#include "adalight.h"
+
+// Maximum size of an encoded frame
+#define ADALIGHT_ENCODED_SIZE(numLeds) (6 + (numLeds) * 3 + ((numLeds) + ADALIGHT_OP_MAX_COUNT - 1) / ADALIGHT_OP_MAX_COUNT)
+#define ADALIGHT_AWA_SIZE(numLeds) (6 + (numLeds) * 3 + 3)
+#define ADALIGHT_TPM2_SIZE(numLeds) (4 + (numLeds) * 3 + 1)
+
+// Encodes the RGB pixels of frame into out, using skip ops for pixels that
+// are equal in previous (the frame the device currently holds, may be NULL).
+// Falls back to a raw frame if compression would not save any bytes.
+// Returns the size of the encoded frame including the header.
+static inline size_t adalight_encode(const uint8_t* frame, const uint8_t* previous, uint16_t numLeds, uint8_t* out)
+{
+    out[0] = 'A';
+    out[1] = 'd';
+    out[2] = 'c';
+    out[3] = (numLeds - 1) >> 8;
+    out[4] = (numLeds - 1) & 0xFF;
+    out[5] = out[3] ^ out[4] ^ 0x55;
+    size_t size = 6;
+
+    uint16_t led = 0;
+    while (led < numLeds)
+    {
+        uint16_t max = numLeds - led;
+        if (max > ADALIGHT_OP_MAX_COUNT) {
+            max = ADALIGHT_OP_MAX_COUNT;
+        }
+
+        // Unchanged pixels cost a single byte
+        uint16_t skip = 0;
+        while (previous && skip < max && !memcmp(&frame[(led + skip) * 3], &previous[(led + skip) * 3], 3)) {
+            skip++;
+        }
+        if (skip) {
+            out[size++] = ADALIGHT_OP_SKIP | (skip - 1);
+            led += skip;
+            continue;
+        }
+
+        // Repeated pixels cost 4 bytes
+        uint16_t run = 1;
+        while (run < max && !memcmp(&frame[(led + run) * 3], &frame[led * 3], 3)) {
+            run++;
+        }
+        if (run >= 2) {
+            out[size++] = ADALIGHT_OP_RUN | (run - 1);
+            memcpy(&out[size], &frame[led * 3], 3);
+            size += 3;
+            led += run;
+            continue;
+        }
+
+        // Literal pixels until a skip or run would start
+        uint16_t literal = 1;
+        while (literal < max) {
+            const uint8_t* pixel = &frame[(led + literal) * 3];
+            if ((previous && !memcmp(pixel, &previous[(led + literal) * 3], 3))
+                || ((literal + 1 < max) && !memcmp(pixel, pixel + 3, 3))) {
+                break;
+            }
+            literal++;
+        }
+        out[size++] = ADALIGHT_OP_LITERAL | (literal - 1);
+        memcpy(&out[size], &frame[led * 3], literal * 3);
+        size += literal * 3;
+        led += literal;
+    }
+
+    // Send raw data if it is smaller
+    if (size >= (size_t)(6 + numLeds * 3)) {
+        out[2] = 'a';
+        memcpy(&out[6], frame, numLeds * 3);
+        size = 6 + numLeds * 3;
+    }
+    return size;
+}
+
+// Encodes the RGB pixels of frame as AWA frame with Fletcher checksums.
+// Returns the size of the encoded frame.
+static inline size_t adalight_encode_awa(const uint8_t* frame, uint16_t numLeds, uint8_t* out)
+{
+    out[0] = 'A';
+    out[1] = 'w';
+    out[2] = 'a';
+    out[3] = (numLeds - 1) >> 8;
+    out[4] = (numLeds - 1) & 0xFF;
+    out[5] = out[3] ^ out[4] ^ 0x55;
+    size_t size = 6;
+
+    uint16_t fletcher1 = 0;
+    uint16_t fletcher2 = 0;
+    uint16_t fletcherExt = 0;
+    for (uint16_t i = 0; i < numLeds * 3; i++) {
+        fletcher1 = (fletcher1 + frame[i]) % 255;
+        fletcher2 = (fletcher2 + fletcher1) % 255;
+        fletcherExt = (fletcherExt + (frame[i] ^ i)) % 255;
+        out[size++] = frame[i];
+    }
+    out[size++] = fletcher1;
+    out[size++] = fletcher2;
+    out[size++] = (fletcherExt == 0x41) ? 0xAA : fletcherExt;
+    return size;
+}
+
+// Encodes the first numBytes of frame as TPM2 data frame.
+// Returns the size of the encoded frame.
+static inline size_t adalight_encode_tpm2(const uint8_t* frame, uint16_t numBytes, uint8_t* out)
+{
+    out[0] = 0xC9;
+    out[1] = 0xDA;
+    out[2] = numBytes >> 8;
+    out[3] = numBytes & 0xFF;
+    memcpy(&out[4], frame, numBytes);
+    out[4 + numBytes] = 0x36;
+    return 4 + numBytes + 1;
+}
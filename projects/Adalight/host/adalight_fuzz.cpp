@@ -0,0 +1,299 @@
+/*
+Copyright (c) 2018 NicoHood
+See the readme for credit to other people.
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+THE SOFTWARE.
+*/
+
+// Feeds random and mutated input into the decoder of every protocol.
+// Valid frames must always be decoded correctly, after a timeout
+// following any kind of garbage input, and the decoder must never write
+// outside of the led array. Build with "make fuzz" to run it with
+// address and undefined behaviour sanitizers.
+//
+// Usage: adalight_fuzz [-n iterations] [-s seed] [-i file]
+// -i decodes a recorded serial stream (e.g. a crash input) with every protocol.
+
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include "fastled.h"
+#include "adalight.h"
+#include "adalight_encoder.h"
+
+#define NUM_LEDS 120
+#define SEGMENT_LEDS 40
+#define TIMEOUT 100
+#define GUARD 16
+#define MAX_INPUT (ADALIGHT_ENCODED_SIZE(NUM_LEDS) + ADALIGHT_AWA_SIZE(NUM_LEDS) * 2)
+
+uint32_t host_millis = 1;
+
+// Led buffers with guard bytes to detect out of bounds writes
+static uint8_t front[NUM_LEDS * 3 + GUARD];
+static uint8_t back[NUM_LEDS * 3 + GUARD];
+
+// Serial input is simulated with a memory stream, read in random chunks
+static const uint8_t* input = NULL;
+static size_t inputSize = 0;
+static size_t inputPos = 0;
+
+static size_t fuzz_read(uint8_t* buff, size_t len)
+{
+    size_t count = inputSize - inputPos;
+    if (len > 1) {
+        len = 1 + rand() % len;
+    }
+    if (count > len) {
+        count = len;
+    }
+    memcpy(buff, &input[inputPos], count);
+    inputPos += count;
+    return count;
+}
+
+static unsigned long errors = 0;
+
+static void check(bool ok, const char* protocol, const char* what, unsigned long iteration)
+{
+    if (!ok) {
+        fprintf(stderr, "%s: %s (iteration %lu)\n", protocol, what, iteration);
+        errors++;
+    }
+}
+
+// Decodes the whole input, returns the last full frame update or 0
+template <template <uint16_t> class protocol>
+static int decode(const uint8_t* data, size_t size, bool segments)
+{
+    input = data;
+    inputSize = size;
+    inputPos = 0;
+
+    // Segments can only be used without a trailer
+    static const uint16_t segmentLeds = protocol<NUM_LEDS>::trailerSize ? NUM_LEDS : SEGMENT_LEDS;
+    int full = 0;
+    int idle = 0;
+    while (idle < 2)
+    {
+        int ret;
+        if (segments) {
+            ret = adalight<fuzz_read, NUM_LEDS, segmentLeds, TIMEOUT, protocol>((CRGB*)front);
+        }
+        else {
+            ret = adalight<fuzz_read, NUM_LEDS, NUM_LEDS, TIMEOUT, protocol>((CRGB*)back, (const CRGB*)front);
+        }
+        if (ret > NUM_LEDS || ret < -2) {
+            return -3;
+        }
+        if (ret == NUM_LEDS) {
+            full = ret;
+            if (!segments) {
+                memcpy(front, back, NUM_LEDS * 3);
+            }
+        }
+        idle = (inputPos >= inputSize) ? idle + 1 : 0;
+    }
+    return full;
+}
+
+// Lets the decoder run into its timeout to start over with a clean state
+template <template <uint16_t> class protocol>
+static void resync(bool segments)
+{
+    host_millis += TIMEOUT + 1;
+    decode<protocol>(front, 0, segments);
+    host_millis += 1;
+}
+
+// Returns true if only a single bit was flipped
+static bool mutate(uint8_t* data, size_t* size)
+{
+    size_t pos = rand() % *size;
+    int mutation = rand() % 4;
+    switch (mutation) {
+    case 0:
+        data[pos] ^= 1 << (rand() % 8);
+        break;
+    case 1:
+        memmove(&data[pos], &data[pos + 1], *size - pos - 1);
+        (*size)--;
+        break;
+    case 2:
+        memmove(&data[pos + 1], &data[pos], *size - pos);
+        data[pos] = rand();
+        (*size)++;
+        break;
+    default:
+        *size = pos + 1;
+        break;
+    }
+    return mutation == 0;
+}
+
+// Encodes a frame, returns the size of the encoded frame and the expected leds
+typedef size_t (*encode_t)(const uint8_t* frame, const uint8_t* previous, uint8_t* out, uint8_t* expected);
+
+static size_t encode_ada(const uint8_t* frame, const uint8_t* previous, uint8_t* out, uint8_t* expected)
+{
+    memcpy(expected, frame, NUM_LEDS * 3);
+    return adalight_encode(frame, previous, NUM_LEDS, out);
+}
+
+static size_t encode_awa(const uint8_t* frame, const uint8_t* previous, uint8_t* out, uint8_t* expected)
+{
+    memcpy(expected, frame, NUM_LEDS * 3);
+    return adalight_encode_awa(frame, NUM_LEDS, out);
+}
+
+// TPM2 frames may contain less or more data than leds
+static size_t encode_tpm2(const uint8_t* frame, const uint8_t* previous, uint8_t* out, uint8_t* expected)
+{
+    uint16_t numBytes = NUM_LEDS * 3;
+    switch (rand() % 4) {
+    case 0:
+        numBytes = rand() % (NUM_LEDS * 3);
+        break;
+    case 1:
+        numBytes += rand() % (NUM_LEDS * 3);
+        break;
+    }
+    uint8_t data[NUM_LEDS * 6];
+    memcpy(data, frame, NUM_LEDS * 3);
+    memset(data + NUM_LEDS * 3, 0x5A, NUM_LEDS * 3);
+    memcpy(expected, previous, NUM_LEDS * 3);
+    memcpy(expected, frame, (numBytes < NUM_LEDS * 3) ? numBytes : NUM_LEDS * 3);
+    return adalight_encode_tpm2(data, numBytes, out);
+}
+
+template <template <uint16_t> class protocol>
+static void fuzz(const char* name, encode_t encode, bool checksum, unsigned long iterations)
+{
+    static uint8_t stream[MAX_INPUT * 2];
+    static uint8_t frame[NUM_LEDS * 3];
+    static uint8_t expected[NUM_LEDS * 3];
+    unsigned long previousErrors = errors;
+    memset(front, 0, sizeof(front));
+    memset(back, 0, sizeof(back));
+
+    for (unsigned long i = 0; i < iterations; i++)
+    {
+        // Alternate between in place decoding (with segments) and a back buffer
+        bool segments = i & 1;
+
+        // Random pixels with some repeated and unchanged ones
+        for (size_t led = 0; led < NUM_LEDS; led++) {
+            int mode = rand() % 4;
+            if (mode == 0) {
+                memcpy(&frame[led * 3], &front[led * 3], 3);
+            }
+            else if (mode == 1 && led) {
+                memcpy(&frame[led * 3], &frame[led * 3 - 3], 3);
+            }
+            else {
+                for (size_t c = 0; c < 3; c++) {
+                    frame[led * 3 + c] = rand() % 4;
+                }
+            }
+        }
+
+        // Garbage: random bytes, a mutated frame or nothing
+        size_t size = 0;
+        bool bitFlip = false;
+        int garbage = rand() % 3;
+        if (garbage == 0) {
+            size = rand() % MAX_INPUT;
+            for (size_t j = 0; j < size; j++) {
+                stream[j] = (rand() % 2) ? rand() : "AdawcC\xC9\xDA\x36"[rand() % 9];
+            }
+        }
+        else if (garbage == 1) {
+            size = encode(frame, front, stream, expected);
+            bitFlip = mutate(stream, &size);
+        }
+        if (size) {
+            int ret = decode<protocol>(stream, size, segments);
+            check(ret >= 0, name, "invalid return value", i);
+            check(!(checksum && bitFlip && ret), name, "corrupted frame accepted", i);
+            check(!memcmp(&front[NUM_LEDS * 3], &back[NUM_LEDS * 3], GUARD), name, "write out of bounds", i);
+            resync<protocol>(segments);
+        }
+
+        // A valid frame must be decoded correctly after any garbage
+        size = encode(frame, front, stream, expected);
+        check(decode<protocol>(stream, size, segments) == NUM_LEDS, name, "valid frame not decoded", i);
+        check(!memcmp(front, expected, NUM_LEDS * 3), name, "wrong pixel data", i);
+        check(!memcmp(&front[NUM_LEDS * 3], &back[NUM_LEDS * 3], GUARD), name, "write out of bounds", i);
+    }
+    resync<protocol>(false);
+    resync<protocol>(true);
+    printf("%-5s %lu iterations, %lu errors\n", name, iterations, errors - previousErrors);
+}
+
+// Decodes a recorded stream with every protocol
+static int replay(const char* path)
+{
+    FILE* file = fopen(path, "rb");
+    if (!file) {
+        perror(path);
+        return 1;
+    }
+    static uint8_t data[1 << 20];
+    size_t size = fread(data, 1, sizeof(data), file);
+    fclose(file);
+
+    int ret = 0;
+    ret |= decode<adalight_protocol_ada>(data, size, false) < 0;
+    ret |= decode<adalight_protocol_ada>(data, size, true) < 0;
+    ret |= decode<adalight_protocol_awa>(data, size, false) < 0;
+    ret |= decode<adalight_protocol_tpm2>(data, size, false) < 0;
+    ret |= memcmp(&front[NUM_LEDS * 3], &back[NUM_LEDS * 3], GUARD) != 0;
+    printf("%s: %zu bytes %s\n", path, size, ret ? "failed" : "ok");
+    return ret;
+}
+
+int main(int argc, char** argv)
+{
+    unsigned long iterations = 20000;
+    unsigned int seed = 1;
+    const char* path = NULL;
+
+    int opt;
+    while ((opt = getopt(argc, argv, "n:s:i:")) != -1) {
+        switch (opt) {
+        case 'n': iterations = strtoul(optarg, NULL, 0); break;
+        case 's': seed = strtoul(optarg, NULL, 0); break;
+        case 'i': path = optarg; break;
+        default:
+            fprintf(stderr, "Usage: %s [-n iterations] [-s seed] [-i file]\n", argv[0]);
+            return 1;
+        }
+    }
+    srand(seed);
+    if (path) {
+        return replay(path);
+    }
+
+    fuzz<adalight_protocol_ada>("ada", encode_ada, false, iterations);
+    fuzz<adalight_protocol_awa>("awa", encode_awa, true, iterations);
+    fuzz<adalight_protocol_tpm2>("tpm2", encode_tpm2, false, iterations);
+    return errors ? 1 : 0;
+}
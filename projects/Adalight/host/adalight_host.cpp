@@ -0,0 +1,182 @@
+/*
+Copyright (c) 2018 NicoHood
+See the readme for credit to other people.
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+THE SOFTWARE.
+*/
+
+#include <stdint.h>
+#include <math.h>
+#include <stdio.h>
+#include <string.h>
+#include <time.h>
+#include "fastled.h"
+#include "adalight.h"
+#include "correction.h"
+#include "interpolation.h"
+
+// Maximum led count of all benchmarks
+#define MAX_LEDS 1200
+#define NUM_BYTES 10000000UL
+
+// Serial baudrate and WS2812 wire time per led for the theoretical frame rate
+#define BAUDRATE 1000000UL
+#define WS2812_US_PER_LED 30UL
+
+uint32_t host_millis = 1;
+CRGB leds[MAX_LEDS];
+
+// Serial input is simulated with a memory stream of consecutive frames
+static uint8_t frame[6 + MAX_LEDS * 3];
+static size_t frameSize = 0;
+static size_t framePos = 0;
+
+static size_t host_read(uint8_t* buff, size_t len)
+{
+    size_t count = frameSize - framePos;
+    if (count > len) {
+        count = len;
+    }
+    memcpy(buff, &frame[framePos], count);
+    framePos += count;
+    return count;
+}
+
+template <uint16_t numLeds, uint16_t segmentLeds>
+static int bench(void)
+{
+    // Generate a valid frame header with some pixel data
+    frameSize = 6 + numLeds * 3;
+    frame[0] = 'A';
+    frame[1] = 'd';
+    frame[2] = 'a';
+    frame[3] = (numLeds - 1) >> 8;
+    frame[4] = (numLeds - 1) & 0xFF;
+    frame[5] = frame[3] ^ frame[4] ^ 0x55;
+    for (size_t i = 6; i < frameSize; i++) {
+        frame[i] = i;
+    }
+
+    // Decode the same frame over and over again
+    unsigned long frames = NUM_BYTES / frameSize;
+    struct timespec start, end;
+    clock_gettime(CLOCK_MONOTONIC, &start);
+    for (unsigned long i = 0; i < frames; i++) {
+        framePos = 0;
+        int ret;
+        do {
+            ret = adalight<host_read, numLeds, segmentLeds>(leds);
+        } while (ret >= 0 && ret != numLeds);
+        if (ret != numLeds || memcmp(leds, &frame[6], numLeds * 3)) {
+            fprintf(stderr, "Frame %lu with %u leds decoded wrong (%d)\n", i, numLeds, ret);
+            return 1;
+        }
+    }
+    clock_gettime(CLOCK_MONOTONIC, &end);
+
+    // Theoretical frame rate if receiving and showing the frame happens one after another
+    double seconds = (end.tv_sec - start.tv_sec) + (end.tv_nsec - start.tv_nsec) / 1e9;
+    double bytes = (double)frames * frameSize;
+    double serialMs = frameSize * 10 * 1000.0 / BAUDRATE;
+    double wireMs = numLeds * WS2812_US_PER_LED / 1000.0;
+    printf("%4u leds, %u segments: %.2f ns/byte decode, %.2fms serial + %.2fms WS2812 = %.1f fps\n",
+           numLeds, numLeds / segmentLeds, seconds * 1e9 / bytes, serialMs, wireMs,
+           1000.0 / (serialMs + wireMs));
+    return 0;
+}
+
+// Compares the compile time lookup tables with the exact values
+// and measures the correction stage per 100 leds
+template <bool dithering>
+static int benchCorrection(void)
+{
+    typedef adalight_correction<25, 0xFFB0F0, dithering> Correction;
+    double scale = dithering ? 256 : 1;
+    double maxError = 0;
+    for (int i = 0; i < 256; i++) {
+        double exact = pow(i / 255.0, 2.5) * scale;
+        maxError = fmax(maxError, fabs(Correction::red::table[i] - exact * 0xFF));
+        maxError = fmax(maxError, fabs(Correction::green::table[i] - exact * 0xB0));
+        maxError = fmax(maxError, fabs(Correction::blue::table[i] - exact * 0xF0));
+    }
+    if (maxError > 0.5) {
+        fprintf(stderr, "Correction table error %.2f\n", maxError);
+        return 1;
+    }
+
+    for (size_t i = 0; i < 100 * 3; i++) {
+        frame[i] = i;
+    }
+    unsigned long frames = NUM_BYTES / 300;
+    struct timespec start, end;
+    clock_gettime(CLOCK_MONOTONIC, &start);
+    for (unsigned long i = 0; i < frames; i++) {
+        Correction::apply((const CRGB*)frame, leds, 100, i);
+        asm volatile("" ::: "memory");
+    }
+    clock_gettime(CLOCK_MONOTONIC, &end);
+    double seconds = (end.tv_sec - start.tv_sec) + (end.tv_nsec - start.tv_nsec) / 1e9;
+    printf("correction%s: %.2f us per 100 leds, table error %.2f\n",
+           dithering ? " with dithering" : "", seconds * 1e6 / frames, maxError);
+    return 0;
+}
+
+// Checks that interpolation reaches both frames and measures it per 100 leds
+static int benchInterpolation(void)
+{
+    static CRGB from[100], to[100];
+    for (size_t i = 0; i < 100 * 3; i++) {
+        ((uint8_t*)from)[i] = i * 7;
+        ((uint8_t*)to)[i] = 255 - i;
+    }
+    adalight_interpolate(from, to, leds, 100, 0);
+    bool ok = !memcmp(leds, from, sizeof(from));
+    adalight_interpolate(from, to, leds, 100, 255);
+    ok = ok && !memcmp(leds, to, sizeof(to));
+    ok = ok && (adalight_interpolation_amount(0, 40) == 0)
+            && (adalight_interpolation_amount(20, 40) == 128)
+            && (adalight_interpolation_amount(50, 40) == 255);
+    if (!ok) {
+        fprintf(stderr, "Interpolation does not reach the frames\n");
+        return 1;
+    }
+
+    unsigned long frames = NUM_BYTES / 300;
+    struct timespec start, end;
+    clock_gettime(CLOCK_MONOTONIC, &start);
+    for (unsigned long i = 0; i < frames; i++) {
+        adalight_interpolate(from, to, leds, 100, i);
+        asm volatile("" ::: "memory");
+    }
+    clock_gettime(CLOCK_MONOTONIC, &end);
+    double seconds = (end.tv_sec - start.tv_sec) + (end.tv_nsec - start.tv_nsec) / 1e9;
+    printf("interpolation: %.2f us per 100 leds\n", seconds * 1e6 / frames);
+    return 0;
+}
+
+int main(void)
+{
+    return bench<25, 25>()
+        || bench<300, 300>()
+        || bench<600, 300>()
+        || bench<1200, 300>()
+        || benchCorrection<false>()
+        || benchCorrection<true>()
+        || benchInterpolation();
+}
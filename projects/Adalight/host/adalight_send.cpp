@@ -0,0 +1,293 @@
+/*
+Copyright (c) 2018 NicoHood
+See the readme for credit to other people.
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+THE SOFTWARE.
+*/
+
+// Stand-in Adalight sender with ACK/credit flow control.
+// Sends frames to a serial port and only sends a new frame if it has a credit.
+// Every pacing token received from the device grants a new credit.
+// Frames are read from a file with raw RGB data or generated as test pattern.
+//
+// Usage: adalight_send -d /dev/ttyACM0 [-b baud] [-n leds] [-c credits] [-r fps] [-t seconds] [-i file] [-z] [-p protocol] [-v]
+// -c 0 sends blind with the fixed frame rate of -r instead.
+// -z sends compressed frames, which requires a device with ADALIGHT_COMPRESSION.
+// -p selects the protocol of the device: ada (default), awa or tpm2.
+// -v prints the telemetry lines of the device (ADALIGHT_TELEMETRY).
+
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <poll.h>
+#include <termios.h>
+#include <time.h>
+#include <unistd.h>
+#include "fastled.h"
+#include "adalight.h"
+#include "adalight_encoder.h"
+
+// Reset the credits if no token was received for this time
+#define CREDIT_TIMEOUT_MS 500
+
+static const struct {
+    unsigned long baud;
+    speed_t speed;
+} baudrates[] = {
+    { 9600, B9600 }, { 19200, B19200 }, { 38400, B38400 }, { 57600, B57600 },
+    { 115200, B115200 }, { 230400, B230400 }, { 460800, B460800 }, { 500000, B500000 },
+    { 921600, B921600 }, { 1000000, B1000000 }, { 2000000, B2000000 },
+};
+
+static double now_ms(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec * 1e3 + ts.tv_nsec / 1e6;
+}
+
+static int open_serial(const char* device, unsigned long baud)
+{
+    int fd = open(device, O_RDWR | O_NOCTTY);
+    if (fd < 0) {
+        fprintf(stderr, "Can't open %s: %s\n", device, strerror(errno));
+        return -1;
+    }
+
+    // Raw mode, the baud rate is ignored by ptys and USB CDC devices
+    struct termios tty;
+    if (tcgetattr(fd, &tty) == 0) {
+        cfmakeraw(&tty);
+        for (size_t i = 0; i < sizeof(baudrates) / sizeof(baudrates[0]); i++) {
+            if (baudrates[i].baud == baud) {
+                cfsetispeed(&tty, baudrates[i].speed);
+                cfsetospeed(&tty, baudrates[i].speed);
+            }
+        }
+        tcsetattr(fd, TCSANOW, &tty);
+    }
+    return fd;
+}
+
+static int write_all(int fd, const uint8_t* buff, size_t len)
+{
+    while (len) {
+        ssize_t ret = write(fd, buff, len);
+        if (ret < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+            return -1;
+        }
+        buff += ret;
+        len -= ret;
+    }
+    return 0;
+}
+
+int main(int argc, char** argv)
+{
+    const char* device = NULL;
+    const char* input = NULL;
+    unsigned long baud = 1000000;
+    unsigned long numLeds = 25;
+    unsigned long maxCredits = 1;
+    double fps = 60;
+    double seconds = 10;
+    bool compress = false;
+    const char* protocol = "ada";
+    bool verbose = false;
+
+    int opt;
+    while ((opt = getopt(argc, argv, "d:b:n:c:r:t:i:zp:v")) != -1) {
+        switch (opt) {
+        case 'd': device = optarg; break;
+        case 'b': baud = strtoul(optarg, NULL, 0); break;
+        case 'n': numLeds = strtoul(optarg, NULL, 0); break;
+        case 'c': maxCredits = strtoul(optarg, NULL, 0); break;
+        case 'r': fps = atof(optarg); break;
+        case 't': seconds = atof(optarg); break;
+        case 'i': input = optarg; break;
+        case 'z': compress = true; break;
+        case 'p': protocol = optarg; break;
+        case 'v': verbose = true; break;
+        default:
+            fprintf(stderr, "Usage: %s -d device [-b baud] [-n leds] [-c credits] "
+                            "[-r fps] [-t seconds] [-i file] [-z] [-p protocol] [-v]\n", argv[0]);
+            return 1;
+        }
+    }
+    bool awa = !strcmp(protocol, "awa");
+    bool tpm2 = !strcmp(protocol, "tpm2");
+    if (!awa && !tpm2 && strcmp(protocol, "ada")) {
+        fprintf(stderr, "Unknown protocol %s\n", protocol);
+        return 1;
+    }
+    if (compress && (awa || tpm2)) {
+        fprintf(stderr, "Only the ada protocol supports compression\n");
+        return 1;
+    }
+    if (!device || !numLeds || numLeds > 0xFFFF / 3 || fps <= 0) {
+        fprintf(stderr, "Invalid arguments, see %s -h\n", argv[0]);
+        return 1;
+    }
+
+    // Frame header
+    size_t frameSize = 6 + numLeds * 3;
+    uint8_t* frame = (uint8_t*)malloc(frameSize);
+    uint8_t* previous = (uint8_t*)malloc(frameSize);
+    uint8_t* encoded = (uint8_t*)malloc(ADALIGHT_ENCODED_SIZE(numLeds) + ADALIGHT_AWA_SIZE(numLeds));
+    if (!frame || !previous || !encoded) {
+        return 1;
+    }
+    frame[0] = 'A';
+    frame[1] = 'd';
+    frame[2] = 'a';
+    frame[3] = (numLeds - 1) >> 8;
+    frame[4] = (numLeds - 1) & 0xFF;
+    frame[5] = frame[3] ^ frame[4] ^ 0x55;
+
+    FILE* file = NULL;
+    if (input && !(file = fopen(input, "rb"))) {
+        fprintf(stderr, "Can't open %s: %s\n", input, strerror(errno));
+        return 1;
+    }
+    int fd = open_serial(device, baud);
+    if (fd < 0) {
+        return 1;
+    }
+
+    unsigned long credits = maxCredits;
+    unsigned long sent = 0;
+    unsigned long long bytes = 0;
+    unsigned long tokens = 0;
+    unsigned long timeouts = 0;
+    char line[128];
+    size_t lineLen = 0;
+    bool inLine = false;
+    double start = now_ms();
+    double lastToken = start;
+    double nextFrame = start;
+    while (now_ms() - start < seconds * 1000)
+    {
+        // Send a frame if a credit is available or the blind frame time has come
+        bool send = maxCredits ? (credits > 0) : (now_ms() >= nextFrame);
+        if (send)
+        {
+            // Read the next frame from the file, start over at its end
+            if (file) {
+                if (fread(frame + 6, 1, frameSize - 6, file) != frameSize - 6) {
+                    rewind(file);
+                    if (fread(frame + 6, 1, frameSize - 6, file) != frameSize - 6) {
+                        fprintf(stderr, "%s contains no full frame\n", input);
+                        return 1;
+                    }
+                }
+            }
+            // Moving test pattern
+            else {
+                for (size_t i = 6; i < frameSize; i++) {
+                    frame[i] = (uint8_t)(i + sent);
+                }
+            }
+
+            // Encode against the previous frame, which the device holds
+            const uint8_t* data = frame;
+            size_t size = frameSize;
+            if (compress) {
+                size = adalight_encode(frame + 6, sent ? previous + 6 : NULL, numLeds, encoded);
+                data = encoded;
+                memcpy(previous, frame, frameSize);
+            }
+            else if (awa) {
+                size = adalight_encode_awa(frame + 6, numLeds, encoded);
+                data = encoded;
+            }
+            else if (tpm2) {
+                size = adalight_encode_tpm2(frame + 6, numLeds * 3, encoded);
+                data = encoded;
+            }
+            bytes += size;
+
+            if (write_all(fd, data, size) < 0) {
+                fprintf(stderr, "Write failed: %s\n", strerror(errno));
+                return 1;
+            }
+            sent++;
+            if (maxCredits) {
+                credits--;
+            }
+            nextFrame += 1000 / fps;
+        }
+
+        // Wait for tokens
+        int waitMs = 0;
+        if (maxCredits) {
+            waitMs = credits ? 0 : 10;
+        }
+        else if (nextFrame > now_ms()) {
+            waitMs = (int)(nextFrame - now_ms());
+        }
+        struct pollfd pfd = { fd, POLLIN, 0 };
+        if (poll(&pfd, 1, waitMs) > 0 && (pfd.revents & POLLIN))
+        {
+            uint8_t buff[64];
+            ssize_t len = read(fd, buff, sizeof(buff));
+            for (ssize_t i = 0; i < len; i++) {
+                // Telemetry lines may contain any character
+                if (inLine || buff[i] == '#') {
+                    inLine = (buff[i] != '\n');
+                    if (lineLen < sizeof(line) - 1) {
+                        line[lineLen++] = buff[i];
+                    }
+                    if (!inLine) {
+                        line[lineLen] = '\0';
+                        if (verbose) {
+                            fputs(line, stderr);
+                        }
+                        lineLen = 0;
+                    }
+                }
+                else if (buff[i] == ADALIGHT_PACING_TOKEN) {
+                    tokens++;
+                    lastToken = now_ms();
+                    if (credits < maxCredits) {
+                        credits++;
+                    }
+                }
+            }
+        }
+
+        // Start over if the device lost a frame (and with it a credit)
+        if (maxCredits && !credits && (now_ms() - lastToken) > CREDIT_TIMEOUT_MS) {
+            credits = maxCredits;
+            lastToken = now_ms();
+            timeouts++;
+        }
+    }
+
+    double elapsed = (now_ms() - start) / 1000;
+    printf("%lu frames of %lu leds in %.2fs: %.1f fps, %.1f bytes/frame, %lu tokens, %lu credit timeouts\n",
+           sent, numLeds, elapsed, sent / elapsed, sent ? (double)bytes / sent : 0.0, tokens, timeouts);
+    close(fd);
+    return 0;
+}
@@ -0,0 +1,182 @@
+/*
+Copyright (c) 2018 NicoHood
+See the readme for credit to other people.
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+THE SOFTWARE.
+*/
+
+// Simulates the serial link between the host and the device byte by byte.
+// The real decoder processes the data, while receiving and showing the leds
+// is modelled with the timing of a 16MHz AVR with WS2812 leds:
+// - Each byte takes 10 bit times on the wire
+// - The USART RX buffer holds USART_BUFFER_RX bytes
+// - While the leds are shown interrupts are disabled, only one byte is kept in UDR
+// - The pacing token reaches the host after HOST_LATENCY_US (USB serial adapter)
+
+#include <stdint.h>
+#include <stdio.h>
+#include <string.h>
+#include "fastled.h"
+#include "adalight.h"
+
+#define MAX_LEDS 1200
+#define BAUDRATE 1000000UL
+#define WS2812_US_PER_LED 30UL
+#define HOST_LATENCY_US 1000UL
+#define USART_BUFFER_RX 64
+#define SIMULATION_US 10000000UL
+
+uint32_t host_millis = 1;
+static CRGB ledBuffers[2][MAX_LEDS];
+
+// USART RX ring buffer
+static uint8_t rx[USART_BUFFER_RX];
+static uint8_t rxHead = 0;
+static uint8_t rxTail = 0;
+
+static size_t sim_read(uint8_t* buff, size_t len)
+{
+    size_t count = 0;
+    while (len-- && rxTail != rxHead) {
+        *buff++ = rx[rxTail];
+        rxTail = (rxTail + 1) % USART_BUFFER_RX;
+        count++;
+    }
+    return count;
+}
+
+static bool sim_receive(uint8_t c)
+{
+    uint8_t next = (rxHead + 1) % USART_BUFFER_RX;
+    if (next == rxTail) {
+        return false;
+    }
+    rx[rxHead] = c;
+    rxHead = next;
+    return true;
+}
+
+template <uint16_t numLeds>
+static void simulate(bool pacing, uint32_t fps)
+{
+    const uint32_t byteUs = 10 * 1000000UL / BAUDRATE;
+    const uint32_t frameSize = 6 + numLeds * 3;
+    const uint8_t header[6] = {
+        'A', 'd', 'a', (numLeds - 1) >> 8, (numLeds - 1) & 0xFF,
+        ((numLeds - 1) >> 8) ^ ((numLeds - 1) & 0xFF) ^ 0x55
+    };
+    CRGB* backLeds = ledBuffers[1];
+
+    // Host state: bytes of the current frame left to send, pending frames and credits
+    uint32_t sendPos = frameSize;
+    uint32_t pendingFrames = 0;
+    uint32_t credits = 1;
+    uint32_t nextFrameUs = 0;
+    uint32_t tokenUs = UINT32_MAX;
+    unsigned long sent = 0;
+
+    // Device state
+    uint32_t busyUntilUs = 0;
+    bool udrFull = false;
+    uint8_t udr = 0;
+    unsigned long shown = 0;
+    unsigned long lost = 0;
+
+    rxHead = rxTail = 0;
+    for (uint32_t us = 0; us < SIMULATION_US; us += byteUs)
+    {
+        host_millis = us / 1000 + 1;
+
+        // Host: queue frames with a fixed rate or whenever a token arrived
+        if (pacing) {
+            if (us >= tokenUs) {
+                credits++;
+                tokenUs = UINT32_MAX;
+            }
+            if (credits && !pendingFrames && sendPos >= frameSize) {
+                credits--;
+                pendingFrames++;
+            }
+        }
+        else if (us >= nextFrameUs) {
+            pendingFrames++;
+            nextFrameUs += 1000000UL / fps;
+        }
+        if (sendPos >= frameSize && pendingFrames) {
+            pendingFrames--;
+            sendPos = 0;
+            sent++;
+        }
+
+        // Wire: transmit one byte
+        if (sendPos < frameSize) {
+            uint8_t c = (sendPos < 6) ? header[sendPos] : (uint8_t)sendPos;
+            sendPos++;
+            if (us < busyUntilUs) {
+                // Interrupts disabled, only UDR keeps one byte
+                if (!udrFull) {
+                    udr = c;
+                    udrFull = true;
+                }
+                else {
+                    lost++;
+                }
+            }
+            else if (!sim_receive(c)) {
+                lost++;
+            }
+        }
+
+        // Device main loop
+        if (us >= busyUntilUs) {
+            if (udrFull) {
+                lost += !sim_receive(udr);
+                udrFull = false;
+            }
+            int ret = adalight<sim_read, numLeds>(backLeds);
+            if (ret == numLeds) {
+                shown++;
+                busyUntilUs = us + numLeds * WS2812_US_PER_LED;
+                tokenUs = busyUntilUs + HOST_LATENCY_US;
+            }
+        }
+    }
+
+    double seconds = SIMULATION_US / 1e6;
+    char mode[16];
+    snprintf(mode, sizeof(mode), pacing ? "paced" : "blind %lufps", (unsigned long)fps);
+    printf("%4u leds, %-11s: %5.1f fps shown, %5.1f fps sent, %4.1f%% dropped, %lu bytes lost\n",
+           numLeds, mode, shown / seconds, sent / seconds,
+           sent ? 100.0 * (sent - shown) / sent : 0.0, lost);
+}
+
+int main(void)
+{
+    // Blind senders just below and above the maximum frame rate
+    simulate<300>(true, 0);
+    simulate<300>(false, 50);
+    simulate<300>(false, 60);
+    simulate<600>(true, 0);
+    simulate<600>(false, 25);
+    simulate<600>(false, 30);
+    simulate<1200>(true, 0);
+    simulate<1200>(false, 13);
+    simulate<1200>(false, 15);
+    return 0;
+}
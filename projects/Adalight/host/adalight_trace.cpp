@@ -0,0 +1,161 @@
+/*
+Copyright (c) 2018 NicoHood
+See the readme for credit to other people.
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+THE SOFTWARE.
+*/
+
+// Compares raw and compressed Adalight frames on a frame trace.
+// Every frame is encoded against the previous one, decoded again with the
+// device decoder and verified. The trace is a file with raw RGB frames of
+// NUM_LEDS leds (-i), or a synthetic ambilight trace is generated.
+//
+// Usage: adalight_trace [-i file] [-b baud]
+
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+#include <unistd.h>
+#include "fastled.h"
+#include "adalight.h"
+#include "adalight_encoder.h"
+
+#ifndef NUM_LEDS
+#define NUM_LEDS 600
+#endif
+#define NUM_BYTES (NUM_LEDS * 3)
+#define SYNTHETIC_FRAMES 3000
+#define WS2812_US_PER_LED 30UL
+
+uint32_t host_millis = 1;
+static CRGB leds[NUM_LEDS];
+
+// Encoded frame as serial input of the decoder
+static uint8_t encoded[ADALIGHT_ENCODED_SIZE(NUM_LEDS)];
+static size_t encodedSize = 0;
+static size_t encodedPos = 0;
+
+static size_t trace_read(uint8_t* buff, size_t len)
+{
+    size_t count = encodedSize - encodedPos;
+    if (count > len) {
+        count = len;
+    }
+    memcpy(buff, &encoded[encodedPos], count);
+    encodedPos += count;
+    return count;
+}
+
+// Synthetic ambilight trace: 24fps video content sent at 60fps,
+// letterbox bars (black top and bottom leds), slowly moving colour
+// gradients and a scene cut every 5 seconds.
+static void synthetic_frame(uint8_t* frame, unsigned long index)
+{
+    unsigned long video = index * 24 / 60;
+    unsigned long scene = video / 120;
+    double t = (video % 120) / 24.0;
+    srand(scene);
+    double hue = rand() % 360;
+    double speed = 0.2 + (rand() % 100) / 100.0;
+
+    for (unsigned long led = 0; led < NUM_LEDS; led++) {
+        // Leds 0-99 and 300-399 are behind the letterbox bars
+        unsigned long side = led % (NUM_LEDS / 2);
+        if (side < NUM_LEDS / 6) {
+            memset(&frame[led * 3], 0, 3);
+            continue;
+        }
+        double pos = (double)led / NUM_LEDS;
+        double v = 0.5 + 0.5 * sin(2 * M_PI * (pos * 2 + t * speed * 0.1));
+        for (int c = 0; c < 3; c++) {
+            double h = fmod(hue + c * 120, 360) / 360.0;
+            frame[led * 3 + c] = (uint8_t)(v * (0.3 + 0.7 * h) * 255);
+        }
+    }
+}
+
+int main(int argc, char** argv)
+{
+    const char* input = NULL;
+    unsigned long baud = 1000000;
+
+    int opt;
+    while ((opt = getopt(argc, argv, "i:b:")) != -1) {
+        switch (opt) {
+        case 'i': input = optarg; break;
+        case 'b': baud = strtoul(optarg, NULL, 0); break;
+        default:
+            fprintf(stderr, "Usage: %s [-i file] [-b baud]\n", argv[0]);
+            return 1;
+        }
+    }
+
+    FILE* file = NULL;
+    if (input && !(file = fopen(input, "rb"))) {
+        perror(input);
+        return 1;
+    }
+
+    static uint8_t frame[NUM_BYTES];
+    static uint8_t previous[NUM_BYTES];
+    unsigned long frames = 0;
+    unsigned long long compressedBytes = 0;
+    while (file ? (fread(frame, 1, NUM_BYTES, file) == NUM_BYTES) : (frames < SYNTHETIC_FRAMES))
+    {
+        if (!file) {
+            synthetic_frame(frame, frames);
+        }
+
+        // The first frame has no previous frame on the device
+        encodedSize = adalight_encode(frame, frames ? previous : NULL, NUM_LEDS, encoded);
+        encodedPos = 0;
+        compressedBytes += encodedSize;
+
+        // Decode in place into the previous frame and verify it
+        int ret;
+        do {
+            ret = adalight<trace_read, NUM_LEDS>(leds);
+        } while (ret == 0 && encodedPos < encodedSize);
+        if (ret != NUM_LEDS || memcmp(leds, frame, NUM_BYTES)) {
+            fprintf(stderr, "Frame %lu decoded wrong (%d)\n", frames, ret);
+            return 1;
+        }
+        memcpy(previous, frame, NUM_BYTES);
+        frames++;
+    }
+    if (!frames) {
+        fprintf(stderr, "No frames of %u leds found\n", NUM_LEDS);
+        return 1;
+    }
+
+    // Frame rates if the serial link is the limit, and with paced WS2812 output
+    double rawSize = 6 + NUM_BYTES;
+    double compressedSize = (double)compressedBytes / frames;
+    double rawMs = rawSize * 10 * 1000 / baud;
+    double compressedMs = compressedSize * 10 * 1000 / baud;
+    double wireMs = NUM_LEDS * WS2812_US_PER_LED / 1000.0;
+    printf("%s trace, %lu frames of %u leds at %lu baud\n", file ? "Recorded" : "Synthetic", frames, NUM_LEDS, baud);
+    printf("raw:        %7.1f bytes/frame, link %5.1f fps, paced WS2812 %5.1f fps\n",
+           rawSize, 1000 / rawMs, 1000 / (rawMs + wireMs));
+    printf("compressed: %7.1f bytes/frame, link %5.1f fps, paced WS2812 %5.1f fps (%.1fx)\n",
+           compressedSize, 1000 / compressedMs, 1000 / (compressedMs + wireMs), rawMs / compressedMs);
+    return 0;
+}
@@ -0,0 +1,63 @@
+/*
+Copyright (c) 2018 NicoHood
+See the readme for credit to other people.
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+THE SOFTWARE.
+*/
+
+// Include guard
+#pragma once
+
+#include <stdint.h>
+#include "fastled.h"
+
+// Writes the pixels between from (amount 0) and to (amount 255) into output.
+// Uses 8 bit fixed point math like lib8tion's lerp8by8(), but reaches both
+// frames exactly: the difference is scaled by (amount + 1) / 256.
+// Output may be the same array as from or to.
+static inline void adalight_interpolate(const CRGB* from, const CRGB* to, CRGB* output,
+                                        uint16_t numLeds, uint8_t amount)
+{
+    const uint8_t* a = (const uint8_t*)from;
+    const uint8_t* b = (const uint8_t*)to;
+    uint8_t* out = (uint8_t*)output;
+    uint16_t scale = amount + 1;
+    for (uint16_t i = 0; i < numLeds * 3; i++) {
+        uint8_t x = a[i];
+        uint8_t y = b[i];
+        if (y >= x) {
+            out[i] = x + (((uint16_t)(y - x) * scale) >> 8);
+        }
+        else {
+            out[i] = x - (((uint16_t)(x - y) * scale) >> 8);
+        }
+    }
+}
+
+// Position of an intermediate frame between the last two received frames,
+// which were received interval ms apart. The output follows the input with
+// a delay of one frame interval and reaches the latest frame after elapsed
+// reaches the interval.
+static inline uint8_t adalight_interpolation_amount(uint32_t elapsed, uint32_t interval)
+{
+    if (elapsed >= interval) {
+        return 255;
+    }
+    return (elapsed * 256) / interval;
+}
@@ -0,0 +1,131 @@
+/*
+Copyright (c) 2018 NicoHood
+See the readme for credit to other people.
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+THE SOFTWARE.
+*/
+
+// Include guard
+#pragma once
+
+#include <stdint.h>
+#include <stddef.h>
+#include <string.h>
+#include "adalight.h"
+
+// Per frame statistics, reported as text line on the same serial stream:
+// #fps=60 lat=12.40 p99=18 rx=10.10 wait=0.20 show=2.10 drop=0 part=0 err=0
+// Times are in ms. lat is the mean time from the first received byte until
+// show() returned, rx the receive time, wait the time until show() started
+// and show the time show() took. p99 is the upper bound of the 1ms latency
+// bucket which contains the 99th percentile. Lines start with '#' and end with
+// '\n', hosts must ignore pacing tokens inside of them. The line contains
+// no 'k' (pacing token).
+#define ADALIGHT_TELEMETRY_BUCKETS 32
+#define ADALIGHT_TELEMETRY_LINE 112
+
+struct adalight_telemetry_t {
+    uint16_t frames;
+    uint16_t dropped;
+    uint32_t receive;
+    uint32_t wait;
+    uint32_t show;
+    uint16_t histogram[ADALIGHT_TELEMETRY_BUCKETS];
+};
+
+// Adds the timestamps (micros) of a shown frame
+static inline void adalight_telemetry_frame(adalight_telemetry_t& telemetry, uint32_t firstByte,
+                                            uint32_t lastByte, uint32_t showStart, uint32_t showEnd)
+{
+    telemetry.frames++;
+    telemetry.receive += lastByte - firstByte;
+    telemetry.wait += showStart - lastByte;
+    telemetry.show += showEnd - showStart;
+
+    uint32_t bucket = (showEnd - firstByte) / 1000;
+    if (bucket >= ADALIGHT_TELEMETRY_BUCKETS) {
+        bucket = ADALIGHT_TELEMETRY_BUCKETS - 1;
+    }
+    telemetry.histogram[bucket]++;
+}
+
+// Appends " name=value", fractions are in 1/100 and limited to 99999.99
+static inline char* adalight_telemetry_append(char* buff, const char* name, uint32_t value, bool fraction)
+{
+    if (fraction && value > 9999999) {
+        value = 9999999;
+    }
+    *buff++ = ' ';
+    while (*name) {
+        *buff++ = *name++;
+    }
+    *buff++ = '=';
+
+    char digits[10];
+    uint8_t count = 0;
+    do {
+        digits[count++] = '0' + (value % 10);
+        value /= 10;
+    } while (value || (fraction && count < 3));
+    while (count) {
+        if (fraction && count == 2) {
+            *buff++ = '.';
+        }
+        *buff++ = digits[--count];
+    }
+    return buff;
+}
+
+// Writes the statistics since the last report into buff
+// (ADALIGHT_TELEMETRY_LINE bytes) and starts a new interval.
+// Returns the length of the line.
+static inline size_t adalight_telemetry_report(adalight_telemetry_t& telemetry, uint32_t intervalMs, char* buff)
+{
+    adalight_frame_times_t& times = adalight_frame_times();
+    uint16_t frames = telemetry.frames ? telemetry.frames : 1;
+
+    // First bucket which contains at least 99% of all frames
+    uint16_t limit = telemetry.frames - telemetry.frames / 100;
+    uint16_t sum = 0;
+    uint8_t p99 = 0;
+    while (p99 < ADALIGHT_TELEMETRY_BUCKETS - 1) {
+        sum += telemetry.histogram[p99];
+        if (sum >= limit) {
+            break;
+        }
+        p99++;
+    }
+
+    char* pos = adalight_telemetry_append(buff, "fps", (telemetry.frames * 1000UL + intervalMs / 2) / intervalMs, false);
+    pos = adalight_telemetry_append(pos, "lat", (telemetry.receive + telemetry.wait + telemetry.show) / frames / 10, true);
+    pos = adalight_telemetry_append(pos, "p99", p99 + 1, false);
+    pos = adalight_telemetry_append(pos, "rx", telemetry.receive / frames / 10, true);
+    pos = adalight_telemetry_append(pos, "wait", telemetry.wait / frames / 10, true);
+    pos = adalight_telemetry_append(pos, "show", telemetry.show / frames / 10, true);
+    pos = adalight_telemetry_append(pos, "drop", telemetry.dropped, false);
+    pos = adalight_telemetry_append(pos, "part", times.partialFrames, false);
+    pos = adalight_telemetry_append(pos, "err", times.syncErrors, false);
+    *pos++ = '\n';
+    buff[0] = '#';
+
+    memset(&telemetry, 0, sizeof(telemetry));
+    times.partialFrames = 0;
+    times.syncErrors = 0;
+    return pos - buff;
+}